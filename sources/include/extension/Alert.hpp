@@ -12,7 +12,10 @@
 #include <libtorrent/alert_types.hpp>
 #include <extension/Status.hpp>
 #include <extension/Common.hpp>
+#include <extension/Metrics.hpp>
+#include <extension/FlightRecorder.hpp>
 #include <exception>
+#include <vector>
 
 /**
  * Modifie version of macro toolkit in libtorrent/alert_types.hpp.
@@ -42,8 +45,14 @@ namespace alert {
     struct TorrentPluginStatusUpdateAlert final : public libtorrent::alert {
 
         TorrentPluginStatusUpdateAlert(libtorrent::aux::stack_allocator&,
-                                 const std::map<libtorrent::sha1_hash, status::TorrentPlugin> & statuses)
-            : statuses(statuses) {}
+                                 std::map<libtorrent::sha1_hash, status::TorrentPlugin> statuses,
+                                 uint64_t generation,
+                                 uint64_t sinceGeneration,
+                                 const status::Transfer & transfer)
+            : statuses(std::move(statuses))
+            , generation(generation)
+            , sinceGeneration(sinceGeneration)
+            , transfer(transfer) {}
 
         TORRENT_DEFINE_ALERT(PluginStatus, libtorrent::user_alert_id + 1)
         static const int static_category = alert::status_notification;
@@ -52,15 +61,28 @@ namespace alert {
         }
 
         std::map<libtorrent::sha1_hash, status::TorrentPlugin> statuses;
+
+        // Generation of plugin state snapshot was taken at, pass
+        // in next request::PostTorrentPluginStatusUpdates to only get changes
+        uint64_t generation;
+
+        // Generation statuses are relative to, i.e. only torrent plugins
+        // which changed after it are included, zero if all are
+        uint64_t sinceGeneration;
+
+        // Paid transfers over all torrents
+        status::Transfer transfer;
     };
 
     struct PeerPluginStatusUpdateAlert final : public libtorrent::torrent_alert {
 
         PeerPluginStatusUpdateAlert(libtorrent::aux::stack_allocator & alloc,
                                     const libtorrent::torrent_handle & h,
-                                    const std::map<libtorrent::peer_id, status::PeerPlugin> & statuses)
+                                    std::map<libtorrent::peer_id, status::PeerPlugin> statuses,
+                                    const boost::optional<libtorrent::peer_id> & nextCursor = boost::none)
             : libtorrent::torrent_alert(alloc, h)
-            , statuses(statuses) {}
+            , statuses(std::move(statuses))
+            , nextCursor(nextCursor) {}
 
         TORRENT_DEFINE_ALERT(PluginStatus, libtorrent::user_alert_id + 2)
         static const int static_category = alert::status_notification;
@@ -69,12 +91,16 @@ namespace alert {
         }
 
         std::map<libtorrent::peer_id, status::PeerPlugin> statuses;
+
+        // Set when statuses were cut short by TorrentPlugin::PeerStatusQuery::maxCount,
+        // use as cursor of query for next page
+        boost::optional<libtorrent::peer_id> nextCursor;
     };
 
     struct RequestResult final : public libtorrent::alert {
 
         RequestResult(libtorrent::aux::stack_allocator&, LoadedCallback loadedCallback)
-            : loadedCallback(loadedCallback) {}
+            : loadedCallback(std::move(loadedCallback)) {}
 
         TORRENT_DEFINE_ALERT(RequestResult, libtorrent::user_alert_id + 3)
         static const int static_category = alert::status_notification;
@@ -86,6 +112,95 @@ namespace alert {
         LoadedCallback loadedCallback;
     };
 
+    struct BatchRequestResult final : public libtorrent::alert {
+
+        BatchRequestResult(libtorrent::aux::stack_allocator&,
+                           LoadedCallback loadedCallback,
+                           std::vector<std::exception_ptr> results)
+            : loadedCallback(std::move(loadedCallback))
+            , results(std::move(results)) {}
+
+        TORRENT_DEFINE_ALERT(BatchRequestResult, libtorrent::user_alert_id + 5)
+        static const int static_category = alert::status_notification;
+        virtual std::string message() const override {
+            return "Batch request result";
+        }
+
+        // A (fully bound) callback object, to be run by libtorrent alert dispatcher,
+        // runs handlers of all requests in batch in submission order, then the batch handler
+        LoadedCallback loadedCallback;
+
+        // Outcome of each request in batch, in submission order, null if successful
+        std::vector<std::exception_ptr> results;
+    };
+
+    struct RequestLatencyStatisticsAlert final : public libtorrent::alert {
+
+        RequestLatencyStatisticsAlert(libtorrent::aux::stack_allocator&,
+                                      std::vector<status::RequestLatency> statistics)
+            : statistics(std::move(statistics)) {}
+
+        TORRENT_DEFINE_ALERT(RequestLatencyStatisticsAlert, libtorrent::user_alert_id + 6)
+        static const int static_category = alert::status_notification;
+        virtual std::string message() const override {
+            return "Request latency statistics";
+        }
+
+        // One entry per type of request processed so far
+        std::vector<status::RequestLatency> statistics;
+    };
+
+    // Posted periodically in place of the per event alerts selected
+    // by TorrentPlugin::Policy::aggregatedAlerts
+    struct AggregatedPeerEventsAlert final : public libtorrent::torrent_alert {
+
+        AggregatedPeerEventsAlert(libtorrent::aux::stack_allocator & alloc,
+                                  const libtorrent::torrent_handle & h,
+                                  std::map<libtorrent::peer_id, status::PeerEvents> events)
+            : libtorrent::torrent_alert(alloc, h)
+            , events(std::move(events)) {}
+
+        TORRENT_DEFINE_ALERT(AggregatedPeerEventsAlert, libtorrent::user_alert_id + 9)
+        static const int static_category = alert::status_notification;
+        virtual std::string message() const override {
+            return torrent_alert::message() + " aggregated peer events";
+        }
+
+        // Events since last alert, for peers with any
+        std::map<libtorrent::peer_id, status::PeerEvents> events;
+    };
+
+    struct MessageLatencyStatisticsAlert final : public libtorrent::alert {
+
+        MessageLatencyStatisticsAlert(libtorrent::aux::stack_allocator&,
+                                      std::vector<status::MessageLatency> statistics)
+            : statistics(std::move(statistics)) {}
+
+        TORRENT_DEFINE_ALERT(MessageLatencyStatisticsAlert, libtorrent::user_alert_id + 8)
+        static const int static_category = alert::status_notification;
+        virtual std::string message() const override {
+            return "Message latency statistics";
+        }
+
+        // One entry per type of message sent or received so far
+        std::vector<status::MessageLatency> statistics;
+    };
+
+    // Posted with every libtorrent::session_stats_alert, when enabled by Plugin::Policy
+    struct MetricsAlert final : public libtorrent::alert {
+
+        MetricsAlert(libtorrent::aux::stack_allocator&, const status::Metrics & metrics)
+            : metrics(metrics) {}
+
+        TORRENT_DEFINE_ALERT(MetricsAlert, libtorrent::user_alert_id + 7)
+        static const int static_category = alert::stats_notification;
+        virtual std::string message() const override {
+            return "Plugin metrics.";
+        }
+
+        status::Metrics metrics;
+    };
+
     struct AnchorAnnounced final : public libtorrent::torrent_alert {
 
         AnchorAnnounced(libtorrent::aux::stack_allocator & alloc,
@@ -134,6 +249,38 @@ namespace alert {
         protocol_session::status::Connection<libtorrent::peer_id> status;
     };
 
+    // Posted when peer plugin drops its connection after something went wrong,
+    // see PeerPlugin::drop and FlightRecorder::noteworthy
+    struct ConnectionFlightRecord : public libtorrent::peer_alert {
+
+        ConnectionFlightRecord(libtorrent::aux::stack_allocator & alloc,
+                               const libtorrent::torrent_handle & h,
+                               const libtorrent::tcp::endpoint & ep,
+                               const libtorrent::peer_id & peer_id,
+                               const libtorrent::error_code & error,
+                               uint64_t recorded,
+                               std::vector<FlightRecord> records)
+            : libtorrent::peer_alert(alloc, h, ep, peer_id)
+            , error(error)
+            , recorded(recorded)
+            , records(std::move(records)) {}
+
+        TORRENT_DEFINE_ALERT(ConnectionFlightRecord, libtorrent::user_alert_id + 10)
+
+        virtual std::string message() const override {
+            return peer_alert::message() + " connection dropped";
+        }
+
+        // Error connection was dropped with
+        libtorrent::error_code error;
+
+        // Number of records ever made on connection, some may have been overwritten
+        uint64_t recorded;
+
+        // Latest records, oldest first
+        std::vector<FlightRecord> records;
+    };
+
     struct ConnectionRemovedFromSession : public libtorrent::peer_alert {
 
         ConnectionRemovedFromSession(libtorrent::aux::stack_allocator & alloc,
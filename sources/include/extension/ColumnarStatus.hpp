@@ -0,0 +1,124 @@
+/**
+ * Copyright (C) JoyStream - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#ifndef JOYSTREAM_EXTENSION_COLUMNAR_STATUS_HPP
+#define JOYSTREAM_EXTENSION_COLUMNAR_STATUS_HPP
+
+#include <extension/Transfer.hpp>
+#include <libtorrent/sha1_hash.hpp>
+#include <libtorrent/peer_id.hpp>
+#include <libtorrent/socket.hpp>
+
+#include <vector>
+#include <cstdint>
+
+namespace joystream {
+namespace extension {
+namespace status {
+
+    // Transfer columns, one row per torrent or peer, see status::Transfer
+    struct TransferColumns {
+
+        void append(const Transfer & transfer) {
+
+            pieceBytesSent.push_back(transfer.piecesSent.amount);
+            pieceBytesReceived.push_back(transfer.piecesReceived.amount);
+            amountSent.push_back(transfer.paymentsSent.amount);
+            amountReceived.push_back(transfer.paymentsReceived.amount);
+
+            pieceBytesSentRate.push_back(transfer.piecesSent.amountRate);
+            pieceBytesReceivedRate.push_back(transfer.piecesReceived.amountRate);
+            amountSentRate.push_back(transfer.paymentsSent.amountRate);
+            amountReceivedRate.push_back(transfer.paymentsReceived.amountRate);
+        }
+
+        void clear() {
+
+            pieceBytesSent.clear();
+            pieceBytesReceived.clear();
+            amountSent.clear();
+            amountReceived.clear();
+
+            pieceBytesSentRate.clear();
+            pieceBytesReceivedRate.clear();
+            amountSentRate.clear();
+            amountReceivedRate.clear();
+        }
+
+        std::vector<uint64_t> pieceBytesSent;
+        std::vector<uint64_t> pieceBytesReceived;
+        std::vector<uint64_t> amountSent;
+        std::vector<uint64_t> amountReceived;
+
+        // Per second
+        std::vector<double> pieceBytesSentRate;
+        std::vector<double> pieceBytesReceivedRate;
+        std::vector<double> amountSentRate;
+        std::vector<double> amountReceivedRate;
+    };
+
+    // Status of all torrent plugins and their peer plugins as struct of arrays,
+    // filled by request::ExportStatus. Columns only ever grow, so a buffer
+    // reused across exports stops allocating once it has seen the largest plugin.
+    //
+    // Schema, bump schemaVersion on any change:
+    //  - torrent columns have one row per torrent plugin
+    //  - peer columns have one row per peer plugin which completed handshake,
+    //    grouped by torrent, rows of torrent i being
+    //    [torrentFirstPeer[i], torrentFirstPeer[i] + torrentPeerCount[i])
+    //  - enumerations are stored as their underlying integer value
+    struct ColumnarStatus {
+
+        static const uint32_t schemaVersion = 1;
+
+        ColumnarStatus()
+            : generation(0) {
+        }
+
+        // Empties all columns, but keeps their capacity
+        void clear() {
+
+            generation = 0;
+
+            torrentInfoHash.clear();
+            torrentSessionMode.clear();
+            torrentLibtorrentInteraction.clear();
+            torrentFirstPeer.clear();
+            torrentPeerCount.clear();
+            torrentTransfer.clear();
+
+            peerId.clear();
+            peerEndPoint.clear();
+            peerBEP10SupportStatus.clear();
+            peerPaymentBEPSupportStatus.clear();
+            peerInSession.clear();
+            peerTransfer.clear();
+        }
+
+        // Plugin wide status generation export was taken at
+        uint64_t generation;
+
+        // Torrent columns
+        std::vector<libtorrent::sha1_hash> torrentInfoHash;
+        std::vector<uint8_t> torrentSessionMode; // protocol_session::SessionMode
+        std::vector<uint8_t> torrentLibtorrentInteraction; // TorrentPlugin::LibtorrentInteraction
+        std::vector<uint32_t> torrentFirstPeer;
+        std::vector<uint32_t> torrentPeerCount;
+        TransferColumns torrentTransfer;
+
+        // Peer columns
+        std::vector<libtorrent::peer_id> peerId;
+        std::vector<libtorrent::tcp::endpoint> peerEndPoint;
+        std::vector<uint8_t> peerBEP10SupportStatus; // BEPSupportStatus
+        std::vector<uint8_t> peerPaymentBEPSupportStatus; // BEPSupportStatus
+        std::vector<uint8_t> peerInSession;
+        TransferColumns peerTransfer;
+    };
+}
+}
+}
+
+#endif // JOYSTREAM_EXTENSION_COLUMNAR_STATUS_HPP
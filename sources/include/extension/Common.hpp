@@ -20,7 +20,8 @@ struct hash<libtorrent::tcp::endpoint> {
     size_t operator()(const libtorrent::tcp::endpoint &) const;
 };
 
-// hash<libtorrent::peer_id> needed for std::unordered_map with this template key
+// hash<libtorrent::peer_id> needed for std::unordered_map with this template key,
+// peer_id is same type as libtorrent::sha1_hash, so also covers info hashes
 template<>
 struct hash<libtorrent::peer_id> {
     size_t operator()(const libtorrent::peer_id &) const;
@@ -188,6 +188,13 @@ namespace exception {
             : std::runtime_error("Torrent files invalid") {}
     };
 
+    // Set on future returned by Plugin::submitWithFuture if request could not be queued
+
+    struct RequestQueueFull : std::runtime_error {
+        RequestQueueFull()
+            : std::runtime_error("Request queue was full") {}
+    };
+
 }
 }
 }
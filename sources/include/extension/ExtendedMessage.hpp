@@ -4,6 +4,7 @@
 
 #include <protocol_wire/char_array_buffer.hpp>
 #include <protocol_wire/NetworkInt.hpp>
+#include <extension/SendBufferPool.hpp>
 
 #include <libtorrent/peer_connection_handle.hpp>
 
@@ -21,16 +22,23 @@ public:
     static const size_t payloadFieldSize = protocol_wire::NetworkInt<uint32_t>::size();
     static const size_t headerSize = payloadFieldSize + messageIdSize + messageIdSize;
 
-    // Construtctor for creating a new extended message
-    ExtendedMessage(size_t payloadSize, uint8_t messageId);
+    // Construtctor for creating a new extended message, in buffer from pool
+    ExtendedMessage(size_t payloadSize, uint8_t messageId, SendBufferPool & pool);
+
+    // Construtctor for message of which only the first bufferedPayloadSize bytes of payload
+    // are held in buffer, the remainder must be appended to connection right after ::send
+    ExtendedMessage(size_t payloadSize, size_t bufferedPayloadSize, uint8_t messageId, SendBufferPool & pool);
 
     std::streambuf* payloadBuf();
 
+    // Start of buffered payload
+    char * payload();
+
     void send(libtorrent::peer_connection_handle &);
 
 private:
     const size_t _size;
-    boost::shared_array<char> _extendedMessageBuffer;
+    SendBufferPool::Buffer _extendedMessageBuffer;
     char_array_buffer _payloadBuffer;
 };
 
@@ -8,9 +8,13 @@
 #ifndef JOYSTREAM_EXTENSION_EXTENDED_MESSAGE_ID_MAPPING_HPP
 #define JOYSTREAM_EXTENSION_EXTENDED_MESSAGE_ID_MAPPING_HPP
 
+#include <extension/MessageType.hpp>
+#include <extension/Exception.hpp>
 #include <libtorrent/bdecode.hpp>
 #include <libtorrent/entry.hpp>
+#include <boost/optional.hpp>
 
+#include <array>
 #include <set>
 #include <map>
 #include <exception>
@@ -18,8 +22,6 @@
 namespace joystream {
 namespace extension {
 
-    enum class MessageType;
-
     // A BEP10 handshake message id mapping for the crypto currency extension.
     // Mapping is either empty or bijective (one-to-one + onto)
     class ExtendedMessageIdMapping {
@@ -37,6 +39,11 @@ namespace extension {
         // Throws: exception::InvalidMessageMappingDictionary
         static ExtendedMessageIdMapping fromMDictionary(const libtorrent::bdecode_node & m);
 
+        // Constructor from extended hanshake dictionary m, which does not throw,
+        // but sets problem and returns empty mapping if dictionary is not valid.
+        static ExtendedMessageIdMapping fromMDictionary(const libtorrent::bdecode_node & m,
+                                                        boost::optional<exception::InvalidMessageMappingDictionary::Problem> & problem);
+
         // Sets all message ids starting at the given parameter
         static ExtendedMessageIdMapping consecutiveIdsStartingAt(uint8_t start);
 
@@ -69,6 +76,10 @@ namespace extension {
         // * NoSuchIdException: if there is no message with given id
         MessageType messageType(uint8_t) const;
 
+        // Returns the message with the given id, or nothing if there is no such
+        // message, or mapping is empty. Does not throw.
+        boost::optional<MessageType> tryMessageType(uint8_t) const;
+
     private:
 
         typedef std::map<MessageType, uint8_t> RawMapping;
@@ -79,12 +90,24 @@ namespace extension {
         // Private default
         ExtendedMessageIdMapping(const RawMapping &);
 
+        // Converts to raw mapping, used when writing mapping
+        RawMapping rawMapping() const;
+
         // Full set of messages used in ma
         const static std::set<MessageType> messages;
 
-        // Message to id mapping
-        // Invariant: _mapping.size() == messages.size()
-        RawMapping _mapping;
+        // Value in _messageTypes of ids without message
+        static const uint8_t noMessageType = 0xff;
+
+        // Whether mapping is empty, in which case tables below are not used
+        bool _empty;
+
+        // Message to id mapping, indexed by MessageType
+        std::array<uint8_t, numberOfMessageTypes> _ids;
+
+        // Id to message mapping, indexed by id, holding MessageType value or noMessageType.
+        // If a peer maps messages to the same id, the lowest message is kept.
+        std::array<uint8_t, 256> _messageTypes;
     };
 }
 }
@@ -0,0 +1,133 @@
+/**
+ * Copyright (C) JoyStream - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#ifndef JOYSTREAM_EXTENSION_FLIGHT_RECORDER_HPP
+#define JOYSTREAM_EXTENSION_FLIGHT_RECORDER_HPP
+
+#include <array>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+
+namespace joystream {
+namespace extension {
+
+// Compact record of something which happened on a connection
+struct FlightRecord {
+
+    enum class Kind : uint8_t {
+
+        // detail is MessageType
+        MessageSent,
+        MessageReceived,
+        MalformedMessage,
+
+        // detail is HandshakeOutcome
+        Handshake,
+
+        AddedToSession,
+
+        // detail is protocol_session::DisconnectCause
+        RemovedFromSession,
+
+        // Peer added to misbehaved peers, detail is protocol_session::DisconnectCause
+        Banned,
+
+        Dropped
+    };
+
+    FlightRecord()
+        : time(0)
+        , size(0)
+        , kind(Kind::Dropped)
+        , detail(0) {
+    }
+
+    // Nanoseconds since epoch of std::chrono::steady_clock
+    int64_t time;
+
+    // Bytes of message, if any
+    uint32_t size;
+
+    Kind kind;
+
+    uint8_t detail;
+};
+
+// Fixed size ring of the latest records of a connection, cheap
+// enough to always be kept. Only used on network thread.
+class FlightRecorder {
+
+public:
+
+    static const std::size_t capacity = 64;
+
+    FlightRecorder()
+        : _recorded(0)
+        , _noteworthy(false) {
+    }
+
+    void record(FlightRecord::Kind kind, uint8_t detail = 0, uint32_t size = 0) {
+
+        FlightRecord & r = _records[_recorded % capacity];
+
+        r.time = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        r.size = size;
+        r.kind = kind;
+        r.detail = detail;
+
+        _recorded++;
+
+        if(kind == FlightRecord::Kind::MalformedMessage ||
+           kind == FlightRecord::Kind::RemovedFromSession ||
+           kind == FlightRecord::Kind::Banned)
+            _noteworthy = true;
+    }
+
+    // Whether records explain something gone wrong, i.e. a malformed message,
+    // a ban, removal from session, or anything else marked so, rather than a routine drop
+    bool noteworthy() const noexcept {
+        return _noteworthy;
+    }
+
+    void markNoteworthy() noexcept {
+        _noteworthy = true;
+    }
+
+    // Records retained, oldest first
+    std::vector<FlightRecord> records() const {
+
+        std::vector<FlightRecord> records;
+
+        const uint64_t first = _recorded > capacity ? _recorded - capacity : 0;
+
+        records.reserve(_recorded - first);
+
+        for(uint64_t i = first;i < _recorded;i++)
+            records.push_back(_records[i % capacity]);
+
+        return records;
+    }
+
+    // Number of records ever made, including ones overwritten
+    uint64_t recorded() const noexcept {
+        return _recorded;
+    }
+
+private:
+
+    std::array<FlightRecord, capacity> _records;
+
+    uint64_t _recorded;
+
+    bool _noteworthy;
+};
+
+}
+}
+
+#endif // JOYSTREAM_EXTENSION_FLIGHT_RECORDER_HPP
@@ -0,0 +1,82 @@
+/**
+ * Copyright (C) JoyStream - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#ifndef JOYSTREAM_EXTENSION_LATENCY_HISTOGRAM_HPP
+#define JOYSTREAM_EXTENSION_LATENCY_HISTOGRAM_HPP
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+namespace joystream {
+namespace extension {
+
+// Histogram of durations with logarithmic buckets, in the style of HdrHistogram:
+// every power of two range of nanoseconds is split into a fixed number of
+// linear sub-buckets, so relative error is bounded (1/8) across the whole range,
+// while memory use and cost of recording are constant.
+// Not synchronized, is meant to be owned by a single thread.
+class LatencyHistogram {
+
+public:
+
+    // Number of linear sub-buckets per power of two is 2^subBucketBits
+    static const int subBucketBits = 3;
+    static const int subBucketCount = 1 << subBucketBits;
+
+    // Largest power of two tracked, larger values end up in last bucket (~36 minutes)
+    static const int maxMagnitude = 41;
+
+    static const int bucketCount = subBucketCount + (maxMagnitude - subBucketBits + 1) * subBucketCount;
+
+    LatencyHistogram();
+
+    void record(const std::chrono::nanoseconds &);
+
+    // Combine with other histogram
+    void add(const LatencyHistogram &);
+
+    void clear();
+
+    // Number of recorded values
+    uint64_t count() const noexcept;
+
+    std::chrono::nanoseconds min() const noexcept;
+
+    std::chrono::nanoseconds max() const noexcept;
+
+    std::chrono::nanoseconds mean() const noexcept;
+
+    // Upper bound of value at given percentile, in range [0, 100]
+    std::chrono::nanoseconds percentile(double) const noexcept;
+
+    // Number of values in bucket
+    uint64_t bucket(int index) const noexcept;
+
+    // Smallest and largest value recorded in bucket with given index
+    static uint64_t bucketLowerBound(int index) noexcept;
+    static uint64_t bucketUpperBound(int index) noexcept;
+
+    // Index of bucket recording value
+    static int bucketIndex(uint64_t nanoseconds) noexcept;
+
+private:
+
+    std::array<uint64_t, bucketCount> _buckets;
+
+    uint64_t _count;
+
+    uint64_t _total;
+
+    uint64_t _min;
+
+    uint64_t _max;
+};
+
+}
+}
+
+#endif // JOYSTREAM_EXTENSION_LATENCY_HISTOGRAM_HPP
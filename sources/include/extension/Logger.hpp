@@ -0,0 +1,181 @@
+/**
+ * Copyright (C) JoyStream - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#ifndef JOYSTREAM_EXTENSION_LOGGER_HPP
+#define JOYSTREAM_EXTENSION_LOGGER_HPP
+
+#include <extension/RequestQueue.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <ostream>
+#include <streambuf>
+#include <thread>
+#include <cstddef>
+#include <cstdint>
+
+// Lowest level of log statements compiled in, statements below it
+// are removed entirely, see LogLevel for values.
+#ifndef JOYSTREAM_EXTENSION_LOG_LEVEL
+#define JOYSTREAM_EXTENSION_LOG_LEVEL 1
+#endif
+
+// Logs streamed expression, e.g. JOYSTREAM_EXTENSION_LOG(Debug, "SENT: " << bytes),
+// only formatting it if level is both compiled in and enabled at runtime.
+// Formatting happens on calling thread, writing happens on logger thread.
+#define JOYSTREAM_EXTENSION_LOG(level, expression) \
+    do { \
+        if(joystream::extension::Logger::compiledIn(joystream::extension::LogLevel::level) && \
+           joystream::extension::Logger::instance().enabled(joystream::extension::LogLevel::level)) { \
+            joystream::extension::LogStatement statement(joystream::extension::LogLevel::level); \
+            statement.stream() << expression; \
+        } \
+    } while(false)
+
+namespace joystream {
+namespace extension {
+
+enum class LogLevel {
+    Trace = 0,
+    Debug = 1,
+    Info = 2,
+    Warning = 3,
+    Error = 4,
+    Off = 5
+};
+
+const char * getLogLevelName(LogLevel);
+
+// Formatted log statement, fixed size so that it can live in ring buffer
+// without allocating. Longer statements are truncated.
+struct LogRecord {
+
+    static const std::size_t maxLength = 240;
+
+    LogRecord()
+        : level(LogLevel::Info)
+        , length(0) {
+    }
+
+    LogLevel level;
+
+    std::size_t length;
+
+    char text[maxLength];
+};
+
+// Process wide logger: statements are queued in a bounded lock-free ring
+// and written to std::clog by a background thread, so logging never blocks
+// the libtorrent network thread on output. Statements are dropped, and counted,
+// if the ring is full.
+class Logger {
+
+public:
+
+    // Capacity of ring, in records
+    static const std::size_t capacity = 1024;
+
+    // How often background thread checks for new records
+    static constexpr std::chrono::milliseconds drainInterval = std::chrono::milliseconds(10);
+
+    static Logger & instance();
+
+    static constexpr bool compiledIn(LogLevel level) {
+        return static_cast<int>(level) >= JOYSTREAM_EXTENSION_LOG_LEVEL && level != LogLevel::Off;
+    }
+
+    ~Logger();
+
+    Logger(const Logger &) = delete;
+    Logger & operator=(const Logger &) = delete;
+
+    // Whether statements of given level are currently logged
+    bool enabled(LogLevel level) const noexcept {
+        return static_cast<int>(level) >= _level.load(std::memory_order_relaxed) && level != LogLevel::Off;
+    }
+
+    // Lowest level logged at runtime, Off disables logging
+    void setLevel(LogLevel);
+    LogLevel level() const noexcept;
+
+    // Queues record for writing, safe to call from any thread
+    void push(const LogRecord &);
+
+    // Blocks until everything queued so far has been written
+    void flush();
+
+    // Number of records dropped since start because ring was full
+    uint64_t dropped() const noexcept;
+
+private:
+
+    Logger();
+
+    // Background thread
+    void run();
+
+    // Writes all queued records, returns whether there were any
+    bool drain();
+
+    std::atomic<int> _level;
+
+    detail::RequestQueue<LogRecord> _records;
+
+    std::atomic<uint64_t> _dropped;
+
+    // Number of dropped records not yet reported in output
+    std::atomic<uint64_t> _droppedUnreported;
+
+    // Serializes draining by background thread and flush
+    std::mutex _drainMutex;
+
+    std::mutex _mutex;
+    std::condition_variable _wakeUp;
+    bool _stopping;
+
+    std::thread _thread;
+};
+
+// Formats a single statement into a LogRecord, which is queued on destruction.
+// Used by JOYSTREAM_EXTENSION_LOG.
+class LogStatement {
+
+public:
+
+    explicit LogStatement(LogLevel);
+
+    ~LogStatement();
+
+    LogStatement(const LogStatement &) = delete;
+    LogStatement & operator=(const LogStatement &) = delete;
+
+    std::ostream & stream() noexcept { return _stream; }
+
+private:
+
+    // Writes into fixed buffer of record, silently truncating
+    class RecordBuffer : public std::streambuf {
+
+    public:
+
+        explicit RecordBuffer(LogRecord &);
+
+        std::size_t length() const;
+    };
+
+    LogRecord _record;
+
+    RecordBuffer _buffer;
+
+    std::ostream _stream;
+};
+
+}
+}
+
+#endif // JOYSTREAM_EXTENSION_LOGGER_HPP
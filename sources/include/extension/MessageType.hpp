@@ -9,6 +9,7 @@
 #define JOYSTREAM_EXTENSION_MESSAGE_TYPE_HPP
 
 #include <string>
+#include <cstddef>
 #include <protocol_wire/protocol_wire.hpp>
 
 namespace joystream {
@@ -28,6 +29,9 @@ namespace extension {
         speedTestPayload
     };
 
+    // Number of values of MessageType, which are consecutive from zero
+    static const std::size_t numberOfMessageTypes = static_cast<std::size_t>(MessageType::speedTestPayload) + 1;
+
     // Get name of message type
     const char * getMessageName(MessageType type);
 
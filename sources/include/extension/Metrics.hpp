@@ -0,0 +1,178 @@
+/**
+ * Copyright (C) JoyStream - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#ifndef JOYSTREAM_EXTENSION_METRICS_HPP
+#define JOYSTREAM_EXTENSION_METRICS_HPP
+
+#include <extension/MessageType.hpp>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+namespace joystream {
+namespace extension {
+
+// Outcome of extended handshake from peer, see PeerPlugin::on_extension_handshake
+enum class HandshakeOutcome {
+
+    // Valid mapping, peer supports extension
+    Accepted,
+
+    // Valid uninstall mapping
+    Uninstalled,
+
+    // Peer does not announce extension
+    NotSupported,
+
+    // Peer announces extension with different major protocol version
+    IncompatibleVersion,
+
+    // Handshake could not be decoded
+    Malformed,
+
+    // Handshake was valid, but should not have been sent,
+    // e.g. without BEP10 support, or a second full mapping
+    Misbehaved
+};
+
+static const std::size_t numberOfHandshakeOutcomes = static_cast<std::size_t>(HandshakeOutcome::Misbehaved) + 1;
+
+namespace status {
+
+    // Counts of extended messages of a single type
+    struct MessageMetrics {
+
+        MessageMetrics()
+            : sent(0)
+            , sentBytes(0)
+            , received(0)
+            , receivedBytes(0) {
+        }
+
+        uint64_t sent;
+        uint64_t sentBytes;
+        uint64_t received;
+        uint64_t receivedBytes;
+    };
+
+    // Snapshot of counters of plugin, see Plugin::metrics
+    struct Metrics {
+
+        Metrics()
+            : malformedMessages(0)
+            , peersBannedForMalformedMessages(0)
+            , peersBannedForMisbehavior(0)
+            , piecesLoaded(0)
+            , pieceLoadFailures(0)
+            , validPiecesArrived(0)
+            , invalidPiecesArrived(0) {
+            handshakes.fill(0);
+        }
+
+        // Extended messages sent and received, indexed by MessageType.
+        // Bytes are of message payload only.
+        std::array<MessageMetrics, numberOfMessageTypes> messages;
+
+        // Extended messages which could not be parsed, causing peer to be dropped
+        uint64_t malformedMessages;
+
+        // Extended handshakes received, indexed by HandshakeOutcome
+        std::array<uint64_t, numberOfHandshakeOutcomes> handshakes;
+
+        // Connections refused due to past behaviour of peer, see TorrentPlugin::Policy
+        uint64_t peersBannedForMalformedMessages;
+        uint64_t peersBannedForMisbehavior;
+
+        // Pieces read from disk for buyers
+        uint64_t piecesLoaded;
+        uint64_t pieceLoadFailures;
+
+        // Pieces from sellers, by outcome of hash check
+        uint64_t validPiecesArrived;
+        uint64_t invalidPiecesArrived;
+    };
+}
+
+// Counters of plugin activity, owned by Plugin.
+// Counters are only written by libtorrent network thread, so an increment is a
+// relaxed load and store, with no read-modify-write, while any thread may take a snapshot.
+class Metrics {
+
+public:
+
+    Metrics();
+
+    void messageSent(MessageType type, std::size_t bytes) {
+        MessageCounters & counters = _messages[static_cast<std::size_t>(type)];
+        add(counters.sent, 1);
+        add(counters.sentBytes, bytes);
+    }
+
+    void messageReceived(MessageType type, std::size_t bytes) {
+        MessageCounters & counters = _messages[static_cast<std::size_t>(type)];
+        add(counters.received, 1);
+        add(counters.receivedBytes, bytes);
+    }
+
+    void malformedMessage() { add(_malformedMessages, 1); }
+
+    void handshake(HandshakeOutcome outcome) { add(_handshakes[static_cast<std::size_t>(outcome)], 1); }
+
+    void peerBannedForMalformedMessages() { add(_peersBannedForMalformedMessages, 1); }
+    void peerBannedForMisbehavior() { add(_peersBannedForMisbehavior, 1); }
+
+    void pieceLoaded() { add(_piecesLoaded, 1); }
+    void pieceLoadFailed() { add(_pieceLoadFailures, 1); }
+
+    void pieceArrived(bool valid) { add(valid ? _validPiecesArrived : _invalidPiecesArrived, 1); }
+
+    // Current value of all counters, safe to call from any thread
+    status::Metrics snapshot() const;
+
+private:
+
+    struct MessageCounters {
+
+        MessageCounters()
+            : sent(0)
+            , sentBytes(0)
+            , received(0)
+            , receivedBytes(0) {
+        }
+
+        std::atomic<uint64_t> sent;
+        std::atomic<uint64_t> sentBytes;
+        std::atomic<uint64_t> received;
+        std::atomic<uint64_t> receivedBytes;
+    };
+
+    // Single writer, so no atomic read-modify-write required
+    static void add(std::atomic<uint64_t> & counter, uint64_t value) {
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+
+    std::array<MessageCounters, numberOfMessageTypes> _messages;
+
+    std::atomic<uint64_t> _malformedMessages;
+
+    std::array<std::atomic<uint64_t>, numberOfHandshakeOutcomes> _handshakes;
+
+    std::atomic<uint64_t> _peersBannedForMalformedMessages;
+    std::atomic<uint64_t> _peersBannedForMisbehavior;
+
+    std::atomic<uint64_t> _piecesLoaded;
+    std::atomic<uint64_t> _pieceLoadFailures;
+
+    std::atomic<uint64_t> _validPiecesArrived;
+    std::atomic<uint64_t> _invalidPiecesArrived;
+};
+
+}
+}
+
+#endif // JOYSTREAM_EXTENSION_METRICS_HPP
@@ -12,6 +12,11 @@
 #include <extension/ExtendedMessageIdMapping.hpp>
 #include <common/MajorMinorSoftwareVersion.hpp>
 #include <extension/MessageType.hpp>
+#include <extension/Metrics.hpp>
+#include <extension/Stopwatch.hpp>
+#include <extension/Logger.hpp>
+#include <extension/Transfer.hpp>
+#include <extension/FlightRecorder.hpp>
 #include <extension/ExtendedMessage.hpp>
 #include <protocol_session/protocol_session.hpp> // TEMPORARY
 
@@ -25,7 +30,9 @@
 #include <libtorrent/bt_peer_connection.hpp>
 #include <libtorrent/disk_buffer_holder.hpp>
 #include <libtorrent/buffer.hpp>
+#include <libtorrent/chained_buffer.hpp> // block_cache_reference
 #include <libtorrent/peer_id.hpp> // sha1_hash
+#include <libtorrent/hasher.hpp>
 
 #include <string>
 #include <chrono>
@@ -35,6 +42,7 @@ namespace extension {
 
 namespace status {
     struct PeerPlugin;
+    struct ColumnarStatus;
 }
 
     class TorrentPlugin;
@@ -145,11 +153,17 @@ namespace status {
         template<class T>
         void send(const T& payload) {
 
+            Stopwatch stopwatch;
+
+            // Large payloads are sent without copying where possible
+            if(sendByReference(payload, stopwatch))
+                return;
+
             const auto size = protocol_wire::OutputWireStream::sizeOf(payload);
 
             auto messageType = getMessageType(payload);
 
-            ExtendedMessage m(size, _peerMapping.id(messageType));
+            ExtendedMessage m(size, _peerMapping.id(messageType), sendBufferPool());
 
             protocol_wire::OutputWireStream writer(m.payloadBuf());
 
@@ -158,24 +172,29 @@ namespace status {
             try {
                 written = writer.write(payload);
             } catch(std::exception &e) {
-                std::clog << "Error Writing message payload, " << getMessageName(messageType) << " message not sent!" << std::endl;
+                JOYSTREAM_EXTENSION_LOG(Error, "Error Writing message payload, " << getMessageName(messageType) << " message not sent!");
                 return;
             }
 
             if(size != written) {
-                std::clog << "Error Payload not fully written, " << getMessageName(messageType) << " message not sent!" << std::endl;
+                JOYSTREAM_EXTENSION_LOG(Error, "Error Payload not fully written, " << getMessageName(messageType) << " message not sent!");
                 return;
             }
 
             // Send message buffer
             m.send(_connection);
 
-            std::clog << "SENT: " << getMessageName(messageType) << " (" << written << ") bytes" << std::endl;
+            messageSent(messageType, written, stopwatch);
+
+            JOYSTREAM_EXTENSION_LOG(Debug, "SENT: " << getMessageName(messageType) << " (" << written << ") bytes");
         }
 
         // Status of plugin
         status::PeerPlugin status(const boost::optional<protocol_session::status::Connection<libtorrent::peer_id>> & connections) const;
 
+        // Appends row with status of plugin to peer columns
+        void exportStatus(status::ColumnarStatus &, bool inSession, const std::chrono::steady_clock::time_point & now) const;
+
         libtorrent::peer_connection_handle connection() const;
 
         libtorrent::tcp::endpoint endPoint() const;
@@ -188,6 +207,17 @@ namespace status {
 
         BEPSupportStatus peerPaymentBEPSupportStatus() const;
 
+        // Records paid transfer over connection, also in torrent and plugin totals
+        void transferred(TransferEvent, uint64_t amount);
+
+        // Latest events on connection, posted in alert::ConnectionFlightRecord when
+        // dropped after something went wrong, see FlightRecorder::noteworthy
+        FlightRecorder & flightRecorder();
+
+        // SHA-1 of piece data, taken as it arrived if it is that of the full piece
+        // message currently being processed, otherwise computed here
+        libtorrent::sha1_hash pieceDataHash(const protocol_wire::PieceData &) const;
+
         // Dropps connection by
         // 1) Issues disconnect request to peer_connection
         // 2) If present, removing from session
@@ -203,6 +233,39 @@ namespace status {
 
     private:
 
+        // Pool of parent plugin which extended messages are written into
+        SendBufferPool & sendBufferPool();
+
+        // Sends message with payload data referenced by connection, rather than copied,
+        // returns false if message was not sent and should be sent by copying
+        template<class T>
+        bool sendByReference(const T &, Stopwatch &) { return false; }
+
+        // Full piece data is handed to connection as is, only BEP10
+        // header and any payload before piece data are copied
+        bool sendByReference(const protocol_wire::FullPiece &, Stopwatch &);
+
+        // Hashes piece data of full piece message received so far in body,
+        // beyond what earlier calls already hashed
+        void hashFullPieceData(libtorrent::buffer::const_interval body);
+
+        // Drops piece data hashed so far, when full piece message is done with, or ignored
+        void resetFullPieceHash();
+
+        // Frees piece data reference handed to connection
+        static void releasePieceData(char *, void * userdata, libtorrent::block_cache_reference);
+
+        // Records sent message in metrics, and time spent sending it
+        void messageSent(MessageType, std::size_t, Stopwatch &);
+
+        // Hands parsed message to torrent plugin, recording time spent
+        // parsing and dispatching it
+        template<class M>
+        void processExtendedMessage(MessageType, const M &, Stopwatch &);
+
+        // Records outcome of extended handshake in metrics
+        void handshakeProcessed(HandshakeOutcome);
+
         // Whether we have initiated dropping the peer, that is disconnecting the peer_connection
         // and removing the peer_plugin reference in the corresponding TorrentPlugin (_plugin)
         // When this is the case, all libtorrent events are ignored, as if this plugin did not exist.
@@ -266,6 +329,23 @@ namespace status {
         // Indicates whether peer supports Payments BEP
         BEPSupportStatus _peerPaymentBEPSupportStatus;
 
+        // Paid transfers over connection
+        TransferAccounting _transfer;
+
+        // Latest events on connection
+        FlightRecorder _flightRecorder;
+
+        // SHA-1 of piece data of full piece message being received, updated as bytes arrive
+        libtorrent::hasher _fullPieceHasher;
+
+        // Bytes of body of full piece message being received which have been hashed,
+        // or skipped for preceeding piece data
+        int _fullPieceBytesHashed;
+
+        // SHA-1 and length of piece data of full piece message being processed
+        boost::optional<libtorrent::sha1_hash> _fullPieceHash;
+        int _fullPieceLength;
+
         // Protocol version announced by peer during extended handshake
         common::MajorMinorSoftwareVersion _protocolVersionOfPeer;
     };
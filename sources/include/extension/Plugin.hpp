@@ -11,6 +11,12 @@
 #include <extension/Status.hpp>
 #include <extension/TorrentPlugin.hpp>
 #include <extension/detail.hpp>
+#include <extension/RequestQueue.hpp>
+#include <extension/Exception.hpp>
+#include <extension/Common.hpp>
+#include <extension/Metrics.hpp>
+#include <extension/Transfer.hpp>
+#include <extension/SendBufferPool.hpp>
 #include <libtorrent/extensions.hpp>
 #include <libtorrent/torrent.hpp>
 #include <libtorrent/alert.hpp>
@@ -20,7 +26,17 @@
 #include <libtorrent/sha1_hash.hpp>
 #include <libtorrent/aux_/session_impl.hpp>
 #include <boost/weak_ptr.hpp>
-#include <mutex>
+#include <boost/optional.hpp>
+#include <array>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <deque>
+#include <unordered_map>
+#include <future>
+#include <memory>
+#include <map>
 
 namespace libtorrent {
     class alert;
@@ -34,10 +50,75 @@ class Plugin : public libtorrent::plugin {
 
 public:
 
+    struct Policy {
+
+        // How ::submit() behaves when the request queue is full
+        enum class Backpressure {
+
+            // Request is dropped, and ::submit() returns false
+            Reject,
+
+            // ::submit() waits for space for at most requestQueueBlockTimeout,
+            // and thereafter behaves as Reject
+            Block
+        };
+
+        Policy()
+            : requestQueueCapacity(4096)
+            , backpressure(Backpressure::Reject)
+            , requestQueueBlockTimeout(100)
+            , wakeNetworkThreadOnSubmit(true)
+            , maxBulkRequestsPerPass(64)
+            , maxRequestsPerPass(1024)
+            , requestProcessingTimeBudget(5000)
+            , postMetricsWithSessionStats(false)
+            , sendBufferPoolCapacity(32 * 1024 * 1024) {
+        }
+
+        // Maximum number of requests waiting to be processed in
+        // each lane, is rounded up to nearest power of two.
+        std::size_t requestQueueCapacity;
+
+        // What to do when queue is full
+        Backpressure backpressure;
+
+        // Longest time ::submit() waits with Backpressure::Block
+        std::chrono::milliseconds requestQueueBlockTimeout;
+
+        // Should ::submit() post a job to the network thread to process
+        // the request queue right away, rather than leaving it for next ::on_tick()
+        bool wakeNetworkThreadOnSubmit;
+
+        // Maximum number of request::Priority::Bulk requests processed in a single
+        // pass over the queue, remaining ones are left for a later pass.
+        // Should be positive.
+        std::size_t maxBulkRequestsPerPass;
+
+        // Maximum number of requests, in any lane, processed in a single pass
+        // over the queue on the network thread, zero means no limit.
+        std::size_t maxRequestsPerPass;
+
+        // Maximum time spent in a single pass over the queue on the network thread,
+        // checked between requests, zero means no limit. Remaining requests
+        // are processed in a later pass.
+        std::chrono::microseconds requestProcessingTimeBudget;
+
+        // Should alert::MetricsAlert be posted along with each libtorrent::session_stats_alert,
+        // i.e. after every libtorrent::session::post_session_stats()
+        bool postMetricsWithSessionStats;
+
+        // Most bytes of unused buffers for outgoing extended messages kept for reuse
+        std::size_t sendBufferPoolCapacity;
+
+        // Policy of each torrent plugin added, e.g. which per peer alerts it aggregates
+        TorrentPlugin::Policy torrentPluginPolicy;
+    };
+
     Plugin(uint minimumMessageId,
            Coin::Network network,
            libtorrent::alert_manager * alertManager = nullptr,
-           libtorrent::aux::session_impl * session = nullptr);
+           libtorrent::aux::session_impl * session = nullptr,
+           const Policy & policy = Policy());
 
     ~Plugin();
 
@@ -54,17 +135,87 @@ public:
     // in response for associating responses to initial
     // requests. Deeper association can be done by subclassing
     // requests to have custome identification data.
+    // Returns false if request was not queued, due to queue
+    // being full, see Policy::Backpressure. Is lock free.
+    // Request is moved into queue when passed as rvalue,
+    // and copied exactly once otherwise.
+    // Request is queued in lane given by request::defaultPriority,
+    // or by given priority.
+    // When an executor is given, it runs the completion of the request
+    // directly from the network thread, and no alert::RequestResult is posted.
+
+    template<class T>
+    bool submit(T &&);
+
+    template<class T>
+    bool submit(T &&, const request::Executor &);
+
+    template<class T>
+    bool submit(T &&, request::Priority, const request::Executor & executor = request::Executor());
 
+    // Submits request, and returns future which is resolved by the network
+    // thread when request completes, bypassing alerts altogether. Any handler set
+    // on request is not run, as it would run on network thread, act on future
+    // instead, or use ::submit() with an executor. If request could not be queued,
+    // future holds exception::RequestQueueFull. Requests with result,
+    // i.e. request::AddTorrent, give future of result.
     template<class T>
-    void submit(const T &);
+    std::future<typename detail::FutureResult<decltype(T::handler)>::type> submitWithFuture(T);
+
+    // Submits all requests as a single queue entry, processed in one pass.
+    // Rather than one alert::RequestResult per request, a single alert::BatchRequestResult
+    // is posted, carrying the outcome of each request and running their handlers,
+    // followed by given batch handler.
+    bool submitBatch(std::vector<detail::RequestVariant> requests, const request::BatchHandler & handler = request::BatchHandler());
+
+    // Number of requests currently waiting in queue, in all lanes or given lane
+    std::size_t requestQueueDepth() const noexcept;
+    std::size_t requestQueueDepth(request::Priority) const noexcept;
+
+    // Number of requests rejected by ::submit() due to full queue
+    uint64_t rejectedRequests() const noexcept;
+
+    // Number of status update requests dropped because an identical
+    // request was already pending, either in ::submit() or while processing queue
+    uint64_t coalescedRequests() const noexcept;
+
+    // Number of passes over the request queue which ended with requests
+    // left behind, due to Policy::maxRequestsPerPass or Policy::requestProcessingTimeBudget
+    uint64_t requestProcessingBudgetExhausted() const noexcept;
+
+    typedef std::unordered_map<libtorrent::sha1_hash, boost::weak_ptr<TorrentPlugin> > TorrentPluginMap;
 
     // Get map of weak torrent plugin references
-    const std::map<libtorrent::sha1_hash, boost::weak_ptr<TorrentPlugin> > & torrentPlugins() const noexcept;
+    const TorrentPluginMap & torrentPlugins() const noexcept;
+
+    // Latest status snapshot published by torrent plugin for given torrent,
+    // with its peer plugins, or null if there is none. Can be called from any
+    // thread, without a round trip through network thread and without entering libtorrent.
+    // Snapshot pointers are read with std::atomic_load, which is not lock free for
+    // std::shared_ptr in common standard libraries, but only ever holds a lock for the
+    // time it takes to copy the pointer, never while a snapshot is being built.
+    // See TorrentPlugin::publishStatus for how fresh snapshot is.
+    std::shared_ptr<const status::TorrentPluginSnapshot> readStatus(const libtorrent::sha1_hash & infoHash) const;
+
+    // Latest status snapshots of all torrent plugins, see ::readStatus
+    std::vector<std::shared_ptr<const status::TorrentPluginSnapshot> > readStatuses() const;
 
     Coin::Network network() const;
 
+    // Snapshot of counters of plugin activity, can be called from any thread
+    status::Metrics metrics() const;
+
+    // Usage of pool of buffers for outgoing extended messages, safe to call from any thread
+    status::SendBufferPool sendBufferPoolStatistics() const;
+
 private:
 
+    // Friendship required to read request statistics
+    friend class detail::RequestVariantVisitor;
+
+    // Friendship required to advance status generation
+    friend class TorrentPlugin;
+
     // Libtorrent alert manager
     libtorrent::alert_manager * _alertManager;
 
@@ -77,41 +228,234 @@ private:
 
     // Has this plugin been added to session.
     // Do not use the _session pointer before this.
-    bool _addedToSession;
+    // Is read by ::submit() on controller threads.
+    std::atomic<bool> _addedToSession;
 
     // Maps torrent hash to corresponding plugin
-    std::map<libtorrent::sha1_hash, boost::weak_ptr<TorrentPlugin> > _torrentPlugins;
+    TorrentPluginMap _torrentPlugins;
+
+    typedef std::unordered_map<libtorrent::sha1_hash, std::shared_ptr<const TorrentPlugin::PublishedStatus> > PublishedStatusMap;
+
+    static const std::size_t numberOfPublishedStatusShards = 64;
+
+    // Maps torrent hash to status published by corresponding plugin, split into
+    // shards by torrent hash. A shard is copied and replaced by network thread when
+    // one of its torrent plugins comes or goes, so adding many torrents does not copy
+    // all statuses every time. Shards are only accessed through std::atomic_load and std::atomic_store.
+    std::array<std::shared_ptr<const PublishedStatusMap>, numberOfPublishedStatusShards> _publishedStatuses;
 
-    // Request queue
-    std::deque<detail::RequestVariant> _requestQueue;
+    // Shard holding status of given torrent
+    std::shared_ptr<const PublishedStatusMap> & publishedStatusShard(const libtorrent::sha1_hash &);
+    const std::shared_ptr<const PublishedStatusMap> & publishedStatusShard(const libtorrent::sha1_hash &) const;
 
-    // Synchronization lock fo _requestQueue, coordinating
-    // public ::submit() and private ::processesRequestQueue()
-    std::mutex _requestQueueMutex;
+    // Adds or removes status of torrent plugin in _publishedStatuses
+    void updatePublishedStatuses(const libtorrent::sha1_hash &, const std::shared_ptr<TorrentPlugin::PublishedStatus> &);
+
+    // Parametrised runtime behaviour
+    const Policy _policy;
+
+    // Request queues, one per request::Priority, written by any thread in
+    // public ::submit(), and read by network thread in private ::processesRequestQueue()
+    detail::RequestQueue<detail::QueuedRequest> _controlRequestQueue;
+    detail::RequestQueue<detail::QueuedRequest> _bulkRequestQueue;
+
+    // Queue for lane
+    detail::RequestQueue<detail::QueuedRequest> & requestQueue(request::Priority);
+    const detail::RequestQueue<detail::QueuedRequest> & requestQueue(request::Priority) const;
+
+    // Number of requests rejected due to full queue
+    std::atomic<uint64_t> _rejectedRequests;
+
+    // Number of status update requests coalesced with an identical pending request
+    std::atomic<uint64_t> _coalescedRequests;
+
+    // Number of passes over queue cut short by budget
+    std::atomic<uint64_t> _requestProcessingBudgetExhausted;
+
+    // Value of _torrentPluginStatusUpdatePending when none is pending
+    static constexpr uint64_t noTorrentPluginStatusUpdatePending = std::numeric_limits<uint64_t>::max();
+
+    // Lowest request::PostTorrentPluginStatusUpdates::sinceGeneration of those submitted while
+    // one is in queue, set by ::submit() and cleared when it is taken off queue.
+    std::atomic<uint64_t> _torrentPluginStatusUpdatePending;
+
+    // Set when a request which set _torrentPluginStatusUpdatePending could not be queued,
+    // network thread then takes over pending status update in its place
+    std::atomic<bool> _torrentPluginStatusUpdateOrphaned;
+
+    // Returns true if request need not be queued, since an
+    // equivalent request is already pending
+    template<class T>
+    bool coalesce(const T &) { return false; }
 
-    // Process all requests in queue until empty.
-    // Access to queue synchronized with ::submit()
+    bool coalesce(const request::PostTorrentPluginStatusUpdates &);
+
+    // Undoes effect of ::coalesce() for request which could not be queued
+    template<class T>
+    void uncoalesce(const T &) {}
+
+    // Requests coalesced with this one were accepted, so its pending
+    // marker is handed to network thread rather than cleared
+    void uncoalesce(const request::PostTorrentPluginStatusUpdates &);
+
+    // Whether a call to ::processesRequestQueue() has been posted to network
+    // thread, and not yet started. Prevents flooding io_service with one job per request.
+    std::atomic<bool> _requestProcessingScheduled;
+
+    // Posts processing of request queue to network thread, unless already pending.
+    // Is called by ::submit(), ::on_tick() remains as fallback.
+    void scheduleRequestProcessing();
+
+    // Latency statistics, indexed by RequestVariant::which()
+    std::array<status::RequestLatency, detail::numberOfRequestTypes> _requestLatencies;
+
+    // Returns latency statistics for type of given request
+    status::RequestLatency & requestLatency(const detail::RequestVariant &);
+
+    // Latency statistics of extended messages, indexed by MessageType,
+    // written by peer plugins
+    std::array<status::MessageLatency, numberOfMessageTypes> _messageLatencies;
+
+    // Paid transfers over all torrents, written by torrent plugins
+    TransferAccounting _transfer;
+
+    // Buffers for outgoing extended messages of all peer plugins
+    SendBufferPool _sendBufferPool;
+
+    // Process all control requests in queue until empty, interleaved
+    // with at most Policy::maxBulkRequestsPerPass bulk requests,
+    // or until budget of pass is used up.
     void processesRequestQueue();
 
+    // Status snapshots taken off queue in current pass, they are idempotent,
+    // so they are deferred to the end of the pass, and duplicates are dropped:
+    // one torrent plugin snapshot, from lowest generation asked for,
+    // and one peer plugin snapshot per torrent.
+    // Executors of deferred requests are kept, first one set is used.
+    uint64_t _torrentPluginStatusUpdatesDeferred;
+    request::Executor _torrentPluginStatusUpdatesDeferredExecutor;
+    std::map<libtorrent::sha1_hash, request::Executor> _peerPluginStatusUpdatesDeferred;
+
+    // Control requests scoped to a single torrent, taken off queue and waiting to
+    // be processed. Torrents take turns having a single request processed,
+    // so one torrent with many requests does not hold up all others.
+    // Requests for any one torrent are processed in order of submission.
+    // Holds at most Policy::requestQueueCapacity requests in total, beyond
+    // which requests are left in control queue, and so subject to backpressure.
+    std::unordered_map<libtorrent::sha1_hash, std::deque<detail::QueuedRequest> > _torrentRequestQueues;
+
+    // Number of requests in _torrentRequestQueues
+    std::size_t _torrentRequestsQueued;
+
+    // Control request not scoped to a torrent, taken off queue while torrent scoped
+    // ones submitted before it are still waiting. It is processed once they are done,
+    // and no more requests are taken off control queue until then.
+    boost::optional<detail::QueuedRequest> _heldControlRequest;
+
+    // Torrents with requests in _torrentRequestQueues, in order of their next turn
+    std::deque<libtorrent::sha1_hash> _torrentRequestRotation;
+
+    // Moves request to queue of its torrent, returns false if it is not torrent scoped
+    bool routeToTorrentRequestQueue(detail::QueuedRequest &);
+
+    // Processes next request of torrent whose turn it is,
+    // returns false if there are no such requests
+    bool processNextTorrentRequest(detail::RequestVariantVisitor &);
+
+    // Process, or defer, a request just taken off queue
+    void dispatchQueuedRequest(detail::RequestVariantVisitor &, detail::QueuedRequest &);
+
+    // Process status snapshots deferred in current pass
+    void processDeferredStatusUpdates(detail::RequestVariantVisitor &);
+
+    // Process a single request taken off queue at given time, with completion
+    // run by given executor if set.
+    void processRequest(detail::RequestVariantVisitor &,
+                        detail::RequestVariant &,
+                        const std::chrono::steady_clock::time_point & dequeued,
+                        const request::Executor & executor = request::Executor());
+
     const Coin::Network _network;
+
+    // Counters of plugin activity, written by torrent and peer plugins
+    Metrics _metrics;
+
+    // Counts changes to torrent plugin statuses, is only used on network thread
+    uint64_t _statusGeneration;
+
+    // Advances status generation, and returns new value
+    uint64_t nextStatusGeneration() noexcept;
 };
 
 // These routines are templated, and therefore inlined
 
 template<class T>
-void Plugin::submit(const T & r) {
+bool Plugin::submit(T && r) {
+    return submit(std::forward<T>(r), request::defaultPriority(r));
+}
+
+template<class T>
+bool Plugin::submit(T && r, const request::Executor & executor) {
+    return submit(std::forward<T>(r), request::defaultPriority(r), executor);
+}
+
+template<class T>
+bool Plugin::submit(T && r, request::Priority priority, const request::Executor & executor) {
 
-    // Put request in container variant
-    detail::RequestVariant v;
+    // Drop idempotent requests already pending
+    if(coalesce(r)) {
+        _coalescedRequests.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
 
-    // Convert to variant
+    // Request is converted to variant directly inside queue slot.
     // Generates compile time guarantee that all submitted requests have been registered in variant
-    v = r;
 
-    // Synchronized adding to back of queue
-    _requestQueueMutex.lock();
-    _requestQueue.push_back(v);
-    _requestQueueMutex.unlock();
+    // Lock free adding to back of queue
+    bool queued;
+
+    const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+    detail::RequestQueue<detail::QueuedRequest> & queue = requestQueue(priority);
+
+    try {
+
+        if(_policy.backpressure == Policy::Backpressure::Block)
+            queued = queue.emplaceUntil(now + _policy.requestQueueBlockTimeout, now, std::forward<T>(r), executor);
+        else
+            queued = queue.tryEmplace(now, std::forward<T>(r), executor);
+
+    } catch(...) {
+
+        // Copying request into queue failed, e.g. std::bad_alloc
+        uncoalesce(r);
+        throw;
+    }
+
+    if(!queued) {
+        uncoalesce(r);
+        _rejectedRequests.fetch_add(1, std::memory_order_relaxed);
+    } else if(_policy.wakeNetworkThreadOnSubmit)
+        scheduleRequestProcessing();
+
+    return queued;
+}
+
+template<class T>
+std::future<typename detail::FutureResult<decltype(T::handler)>::type> Plugin::submitWithFuture(T r) {
+
+    typedef typename detail::FutureResult<decltype(T::handler)>::type Result;
+
+    std::shared_ptr<std::promise<Result> > promise = std::make_shared<std::promise<Result> >();
+    std::future<Result> future = promise->get_future();
+
+    r.handler = detail::resolving(promise, r.handler);
+
+    // Promise is resolved right in network thread, no need for an alert
+    if(!submit(std::move(r), request::Executor(&detail::runInline)))
+        promise->set_exception(std::make_exception_ptr(exception::RequestQueueFull()));
+
+    return future;
 }
 
 }
@@ -9,12 +9,14 @@
 #define JOYSTREAM_EXTENSION_REQUEST_HPP
 
 #include <extension/TorrentPlugin.hpp>
+#include <extension/ColumnarStatus.hpp>
 #include <protocol_wire/protocol_wire.hpp>
 #include <protocol_session/protocol_session.hpp>
 #include <libtorrent/sha1_hash.hpp>
 #include <libtorrent/socket.hpp>
 
 #include <functional>
+#include <vector>
 
 namespace joystream {
 namespace extension {
@@ -29,6 +31,27 @@ typedef std::function <void(void)> NoExceptionSubroutineHandler;
 // A standard handler which handles requests without an explicit result, i.e. subroutine
 typedef std::function<void(const std::exception_ptr &)> SubroutineHandler;
 
+// Handler for a batch of requests, see Plugin::submitBatch. Gets outcome
+// of each request in the batch, in submission order, null when successful.
+typedef std::function<void(const std::vector<std::exception_ptr> &)> BatchHandler;
+
+// Lane in which a request waits to be processed, see Plugin::submit
+enum class Priority {
+
+    // Changes to session, torrents or peers, always processed first
+    Control,
+
+    // Status snapshots and other bulk work, processed with what
+    // is left of each pass once control requests are done
+    Bulk
+};
+
+// Runs completion of a request, i.e. bound request handler, in place of it being
+// delivered through alert::RequestResult, see Plugin::submit. Is called on libtorrent
+// network thread while request queue is processed, so should return promptly,
+// e.g. by handing completion over to a thread of the callers choosing.
+typedef std::function<void(std::function<void()>)> Executor;
+
 // A standard handler which handles requests with and explicit result, i.e. a function
 //template<typename... Args>
 //using FunctionHandler = std::function<void(const std::exception_ptr &, Args... args)>;
@@ -85,17 +108,61 @@ struct ResumeTorrent {
 
 /// Plugin requests
 
+// Posts alert::TorrentPluginStatusUpdateAlert. When sinceGeneration is set to the
+// generation of the last alert received, only torrent plugins whose status
+// has changed since then are included, otherwise all are. Removal of
+// torrents is not reported, see libtorrent::torrent_removed_alert.
 struct PostTorrentPluginStatusUpdates {
 
-    PostTorrentPluginStatusUpdates() {}
+    PostTorrentPluginStatusUpdates(uint64_t sinceGeneration = 0)
+        : sinceGeneration(sinceGeneration) {}
+
+    uint64_t sinceGeneration;
 };
 
+// Posts alert::PeerPluginStatusUpdateAlert with statuses of peer plugins
+// of given torrent matching query, see TorrentPlugin::peerStatuses.
 struct PostPeerPluginStatusUpdates {
 
-    PostPeerPluginStatusUpdates(const libtorrent::sha1_hash & infoHash)
-        : _infoHash(infoHash) {}
+    PostPeerPluginStatusUpdates(const libtorrent::sha1_hash & infoHash,
+                                const TorrentPlugin::PeerStatusQuery & query = TorrentPlugin::PeerStatusQuery())
+        : _infoHash(infoHash)
+        , query(query) {}
 
     libtorrent::sha1_hash _infoHash;
+
+    TorrentPlugin::PeerStatusQuery query;
+};
+
+// Posts alert::RequestLatencyStatisticsAlert with queue wait and
+// execution time histograms for each type of request processed so far
+struct PostRequestLatencyStatistics {
+
+    PostRequestLatencyStatistics() {}
+};
+
+// Posts alert::MessageLatencyStatisticsAlert with parse, dispatch and
+// send latencies of each type of extended message handled so far
+struct PostMessageLatencyStatistics {
+
+    PostMessageLatencyStatistics() {}
+};
+
+// Writes status of all torrent plugins and peer plugins into given columns,
+// which are cleared first, in one pass. Passing the columns of the previous
+// export back in avoids allocating. Handler gets columns back, or a new
+// buffer if none was given.
+struct ExportStatus {
+
+    typedef std::function<void(const std::shared_ptr<status::ColumnarStatus> &)> ExportStatusHandler;
+
+    ExportStatus(const std::shared_ptr<status::ColumnarStatus> & columns, const ExportStatusHandler & handler)
+        : columns(columns)
+        , handler(handler) {
+    }
+
+    std::shared_ptr<status::ColumnarStatus> columns;
+    ExportStatusHandler handler;
 };
 
 struct PauseLibtorrent {
@@ -334,6 +401,19 @@ struct ChangeDownloadLocation : public TorrentPluginRequest {
     int pieceIndex;
 };
 */
+
+// Lane used for a request when caller does not pick one. Requests which control
+// requests may depend on, e.g. AddTorrent followed by Start, stay in control lane,
+// as it is drained first, and lanes do not preserve order among each other.
+template<class T>
+inline Priority defaultPriority(const T &) { return Priority::Control; }
+
+inline Priority defaultPriority(const PostTorrentPluginStatusUpdates &) { return Priority::Bulk; }
+inline Priority defaultPriority(const PostPeerPluginStatusUpdates &) { return Priority::Bulk; }
+inline Priority defaultPriority(const PostRequestLatencyStatistics &) { return Priority::Bulk; }
+inline Priority defaultPriority(const PostMessageLatencyStatistics &) { return Priority::Bulk; }
+inline Priority defaultPriority(const ExportStatus &) { return Priority::Bulk; }
+
 }
 }
 }
@@ -0,0 +1,259 @@
+/**
+ * Copyright (C) JoyStream - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#ifndef JOYSTREAM_EXTENSION_REQUEST_QUEUE_HPP
+#define JOYSTREAM_EXTENSION_REQUEST_QUEUE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <cstddef>
+#include <cassert>
+
+namespace joystream {
+namespace extension {
+namespace detail {
+
+// Bounded lock-free queue for many producers (controller threads calling Plugin::submit)
+// and a single consumer (libtorrent network thread draining the queue).
+//
+// Based on the array based queue of D. Vyukov: each slot carries a sequence number
+// which tells producers and the consumer whether the slot is free for the
+// current lap around the ring. Producers claim a slot with a single CAS on the tail,
+// the consumer never contends with anyone on the head.
+template<class T>
+class RequestQueue {
+
+public:
+
+    // Capacity is rounded up to nearest power of two
+    explicit RequestQueue(std::size_t capacity)
+        : _capacity(roundUpToPowerOfTwo(capacity))
+        , _mask(_capacity - 1)
+        , _slots(new Slot[_capacity])
+        , _tail(0)
+        , _head(0)
+        , _size(0) {
+
+        for(std::size_t i = 0;i < _capacity;i++)
+            _slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    ~RequestQueue() {
+
+        // Destroy whatever was never consumed
+        for(std::size_t head = _head.load(std::memory_order_relaxed);;head++) {
+
+            Slot & slot = _slots[head & _mask];
+
+            if(slot.sequence.load(std::memory_order_acquire) != head + 1)
+                break;
+
+            if(slot.constructed)
+                reinterpret_cast<T *>(&slot.storage)->~T();
+        }
+    }
+
+    RequestQueue(const RequestQueue &) = delete;
+    RequestQueue & operator=(const RequestQueue &) = delete;
+
+    // Attempts to construct element in place at back of queue, returns false if queue is full,
+    // in which case arguments are left untouched. Safe to call from any number of threads.
+    // If construction throws, exception is rethrown, and nothing is added to queue.
+    template<class... Args>
+    bool tryEmplace(Args &&... args) {
+
+        Slot * slot = claimSlot();
+
+        if(slot == nullptr)
+            return false;
+
+        try {
+            new (&slot->storage) T(std::forward<Args>(args)...);
+        } catch(...) {
+
+            // Slot is already claimed, and consumer waits for it in order,
+            // so it is published empty and skipped by consumer
+            slot->constructed = false;
+            publish(slot);
+
+            throw;
+        }
+
+        slot->constructed = true;
+        publish(slot);
+
+        return true;
+    }
+
+    // Attempts to construct element, and spins/sleeps until space is available or deadline passes,
+    // returns false if deadline passed. Safe to call from any number of threads.
+    template<class... Args>
+    bool emplaceUntil(const std::chrono::steady_clock::time_point & deadline, Args &&... args) {
+
+        for(unsigned int attempt = 0;;attempt++) {
+
+            // Arguments are only consumed on success, so safe to forward repeatedly
+            if(tryEmplace(std::forward<Args>(args)...))
+                return true;
+
+            if(std::chrono::steady_clock::now() >= deadline)
+                return false;
+
+            backoff(attempt);
+        }
+    }
+
+    bool tryPush(T && value) {
+        return tryEmplace(std::move(value));
+    }
+
+    bool pushUntil(T && value, const std::chrono::steady_clock::time_point & deadline) {
+        return emplaceUntil(deadline, std::move(value));
+    }
+
+    // Attempts to remove element from front of queue, returns false if queue is empty.
+    // Must only be called by the single consumer.
+    bool tryPop(T & value) {
+
+        for(;;) {
+
+            const std::size_t head = _head.load(std::memory_order_relaxed);
+            Slot & slot = _slots[head & _mask];
+
+            // Slot is only readable when producer has published it for this lap
+            if(slot.sequence.load(std::memory_order_acquire) != head + 1)
+                return false;
+
+            const bool constructed = slot.constructed;
+
+            if(constructed) {
+
+                T * element = reinterpret_cast<T *>(&slot.storage);
+                value = std::move(*element);
+                element->~T();
+            }
+
+            // Hand slot back to producers for next lap
+            slot.sequence.store(head + _capacity, std::memory_order_release);
+            _head.store(head + 1, std::memory_order_relaxed);
+
+            _size.fetch_sub(1, std::memory_order_relaxed);
+
+            // Skip slot left empty by failed construction
+            if(constructed)
+                return true;
+        }
+    }
+
+    // Approximate number of elements in queue, exact when no push/pop is in flight
+    std::size_t size() const noexcept {
+        return _size.load(std::memory_order_relaxed);
+    }
+
+    bool empty() const noexcept {
+        return size() == 0;
+    }
+
+    std::size_t capacity() const noexcept {
+        return _capacity;
+    }
+
+private:
+
+    struct Slot {
+
+        std::atomic<std::size_t> sequence;
+
+        // Whether storage holds an element, false if its construction threw,
+        // written by producer before publishing slot
+        bool constructed;
+
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+    };
+
+    // Reserves a slot for writing, or returns nullptr if queue is full
+    Slot * claimSlot() {
+
+        std::size_t tail = _tail.load(std::memory_order_relaxed);
+
+        for(;;) {
+
+            Slot & slot = _slots[tail & _mask];
+
+            const std::size_t sequence = slot.sequence.load(std::memory_order_acquire);
+            const std::ptrdiff_t difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(tail);
+
+            if(difference == 0) {
+
+                // Slot is free for this lap, try to claim it
+                if(_tail.compare_exchange_weak(tail, tail + 1, std::memory_order_relaxed))
+                    return &slot;
+
+            } else if(difference < 0) {
+
+                // Consumer has not released slot from previous lap: full
+                return nullptr;
+
+            } else
+                tail = _tail.load(std::memory_order_relaxed);
+        }
+    }
+
+    // Makes claimed slot visible to consumer
+    void publish(Slot * slot) {
+
+        const std::size_t sequence = slot->sequence.load(std::memory_order_relaxed);
+
+        _size.fetch_add(1, std::memory_order_relaxed);
+
+        slot->sequence.store(sequence + 1, std::memory_order_release);
+    }
+
+    static void backoff(unsigned int attempt) {
+
+        if(attempt < 16)
+            std::this_thread::yield();
+        else
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+
+    static std::size_t roundUpToPowerOfTwo(std::size_t n) {
+
+        std::size_t power = 2;
+
+        while(power < n)
+            power <<= 1;
+
+        return power;
+    }
+
+    const std::size_t _capacity;
+
+    const std::size_t _mask;
+
+    std::unique_ptr<Slot[]> _slots;
+
+    // Producer and consumer positions are kept on separate cache lines,
+    // to avoid network thread and controller threads invalidating each other
+    char _padding0[64];
+    std::atomic<std::size_t> _tail;
+    char _padding1[64];
+    std::atomic<std::size_t> _head;
+    char _padding2[64];
+
+    // Number of elements in queue
+    std::atomic<std::size_t> _size;
+};
+
+}
+}
+}
+
+#endif // JOYSTREAM_EXTENSION_REQUEST_QUEUE_HPP
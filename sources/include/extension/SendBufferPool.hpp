@@ -0,0 +1,166 @@
+/**
+ * Copyright (C) JoyStream - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#ifndef JOYSTREAM_EXTENSION_SEND_BUFFER_POOL_HPP
+#define JOYSTREAM_EXTENSION_SEND_BUFFER_POOL_HPP
+
+#include <array>
+#include <vector>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+namespace joystream {
+namespace extension {
+namespace status {
+
+    // Usage of send buffer pool, see Plugin::sendBufferPoolStatistics
+    struct SendBufferPool {
+
+        SendBufferPool()
+            : hits(0)
+            , misses(0)
+            , buffersInUse(0)
+            , peakBuffersInUse(0)
+            , bytesInUse(0)
+            , peakBytesInUse(0)
+            , requestedBytesInUse(0)
+            , peakRequestedBytesInUse(0)
+            , bytesPooled(0) {
+        }
+
+        // Buffers handed out from pool, and ones which had to be allocated
+        uint64_t hits;
+        uint64_t misses;
+
+        uint64_t buffersInUse;
+        uint64_t peakBuffersInUse;
+
+        // By capacity of buffers
+        uint64_t bytesInUse;
+        uint64_t peakBytesInUse;
+
+        // By size asked for, compare with capacity for share lost to rounding up
+        uint64_t requestedBytesInUse;
+        uint64_t peakRequestedBytesInUse;
+
+        // Held by pool for reuse
+        uint64_t bytesPooled;
+    };
+}
+
+// Pool of buffers for outgoing extended messages, shared by all peer plugins.
+// Buffers come in size classes of a power of two, from smallestBufferSize up to
+// largestBufferSize, plus messageOverhead, larger ones are allocated and freed on every use.
+// The overhead makes a message carrying a power of two sized piece fit class of that size,
+// rather than taking a buffer twice that size.
+// Buffers are acquired and released on libtorrent network thread only,
+// while statistics can be read from any thread.
+class SendBufferPool {
+
+public:
+
+    static const std::size_t smallestBufferSize = 256;
+    static const std::size_t numberOfSizeClasses = 17;
+    static const std::size_t largestBufferSize = smallestBufferSize << (numberOfSizeClasses - 1); // 16 MiB
+
+    // Room for extended message header, and whatever preceeds piece data in a full piece message
+    static const std::size_t messageOverhead = 64;
+
+    // Buffer on loan from pool, returned when destroyed
+    class Buffer {
+
+    public:
+
+        Buffer();
+        ~Buffer();
+
+        Buffer(Buffer &&);
+        Buffer & operator=(Buffer &&);
+
+        Buffer(const Buffer &) = delete;
+        Buffer & operator=(const Buffer &) = delete;
+
+        char * data() const noexcept { return _data; }
+
+        std::size_t capacity() const noexcept { return _capacity; }
+
+        // Size asked for
+        std::size_t size() const noexcept { return _size; }
+
+    private:
+
+        friend class SendBufferPool;
+
+        Buffer(SendBufferPool *, char *, std::size_t size, std::size_t capacity, std::size_t sizeClass);
+
+        void release();
+
+        SendBufferPool * _pool;
+
+        char * _data;
+
+        std::size_t _size;
+
+        std::size_t _capacity;
+
+        std::size_t _sizeClass;
+    };
+
+    // Buffers beyond maxPooledBytes in total are freed when released
+    explicit SendBufferPool(std::size_t maxPooledBytes);
+
+    ~SendBufferPool();
+
+    SendBufferPool(const SendBufferPool &) = delete;
+    SendBufferPool & operator=(const SendBufferPool &) = delete;
+
+    // Buffer of at least given size
+    Buffer acquire(std::size_t size);
+
+    status::SendBufferPool statistics() const;
+
+private:
+
+    void release(char *, std::size_t size, std::size_t capacity, std::size_t sizeClass);
+
+    // Size class of smallest buffers fitting size, numberOfSizeClasses if none does
+    static std::size_t sizeClass(std::size_t size);
+
+    // Single writer, so no atomic read-modify-write required
+    static void add(std::atomic<uint64_t> & counter, uint64_t value) {
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+
+    static void subtract(std::atomic<uint64_t> & counter, uint64_t value) {
+        counter.store(counter.load(std::memory_order_relaxed) - value, std::memory_order_relaxed);
+    }
+
+    static void raise(std::atomic<uint64_t> & peak, uint64_t value) {
+        if(value > peak.load(std::memory_order_relaxed))
+            peak.store(value, std::memory_order_relaxed);
+    }
+
+    const std::size_t _maxPooledBytes;
+
+    // Released buffers of each size class
+    std::array<std::vector<char *>, numberOfSizeClasses> _free;
+
+    std::atomic<uint64_t> _hits;
+    std::atomic<uint64_t> _misses;
+    std::atomic<uint64_t> _buffersInUse;
+    std::atomic<uint64_t> _peakBuffersInUse;
+    std::atomic<uint64_t> _bytesInUse;
+    std::atomic<uint64_t> _peakBytesInUse;
+    std::atomic<uint64_t> _requestedBytesInUse;
+    std::atomic<uint64_t> _peakRequestedBytesInUse;
+    std::atomic<uint64_t> _bytesPooled;
+};
+
+}
+}
+
+#endif // JOYSTREAM_EXTENSION_SEND_BUFFER_POOL_HPP
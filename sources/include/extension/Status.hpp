@@ -10,6 +10,8 @@
 
 #include <extension/BEPSupportStatus.hpp>
 #include <extension/TorrentPlugin.hpp>
+#include <extension/LatencyHistogram.hpp>
+#include <extension/Transfer.hpp>
 #include <protocol_session/protocol_session.hpp>
 #include <libtorrent/socket.hpp>
 #include <libtorrent/sha1_hash.hpp>
@@ -17,6 +19,7 @@
 #include <boost/optional.hpp>
 
 #include <map>
+#include <string>
 
 namespace joystream {
 namespace extension {
@@ -52,6 +55,53 @@ namespace status {
 
         // *** TEMPORARY ***: Status of connection
         boost::optional<protocol_session::status::Connection<libtorrent::peer_id>> connection;
+
+        // Paid transfers over connection
+        Transfer transfer;
+    };
+
+    // Events of a single peer aggregated over an interval, see TorrentPlugin::Policy::aggregatedAlerts.
+    // Totals and last values are those of the latest event of each kind.
+    struct PeerEvents {
+
+        PeerEvents()
+            : connectionsAddedToSession(0)
+            , validPaymentsReceived(0)
+            , amountReceived(0)
+            , totalNumberOfPaymentsReceived(0)
+            , totalAmountReceived(0)
+            , paymentsSent(0)
+            , amountSent(0)
+            , totalNumberOfPaymentsSent(0)
+            , totalAmountSent(0)
+            , lastPaidPieceIndex(-1)
+            , validPiecesArrived(0)
+            , lastArrivedPieceIndex(-1) {
+        }
+
+        // Endpoint
+        libtorrent::tcp::endpoint endPoint;
+
+        // Replaces alert::ConnectionAddedToSession
+        unsigned int connectionsAddedToSession;
+        boost::optional<protocol_session::status::Connection<libtorrent::peer_id>> connection;
+
+        // Replaces alert::ValidPaymentReceived
+        uint64_t validPaymentsReceived;
+        uint64_t amountReceived;
+        uint64_t totalNumberOfPaymentsReceived;
+        uint64_t totalAmountReceived;
+
+        // Replaces alert::SentPayment
+        uint64_t paymentsSent;
+        uint64_t amountSent;
+        uint64_t totalNumberOfPaymentsSent;
+        uint64_t totalAmountSent;
+        int lastPaidPieceIndex;
+
+        // Replaces alert::ValidPieceArrived
+        uint64_t validPiecesArrived;
+        int lastArrivedPieceIndex;
     };
 
     struct TorrentPlugin {
@@ -74,6 +124,65 @@ namespace status {
 
         // Libtorrent Interaction mode
         extension::TorrentPlugin::LibtorrentInteraction libtorrentInteraction;
+
+        // Paid transfers over all connections, also past ones
+        Transfer transfer;
+    };
+
+    // Status of torrent plugin and its peer plugins, as last published
+    // by network thread, see Plugin::readStatus
+    struct TorrentPluginSnapshot {
+
+        TorrentPluginSnapshot() : generation(0) {}
+
+        TorrentPluginSnapshot(const TorrentPlugin & torrentPlugin,
+                              std::map<libtorrent::peer_id, PeerPlugin> peers,
+                              uint64_t generation)
+            : torrentPlugin(torrentPlugin)
+            , peers(std::move(peers))
+            , generation(generation) {
+        }
+
+        TorrentPlugin torrentPlugin;
+
+        // Peer plugins which have completed handshake
+        std::map<libtorrent::peer_id, PeerPlugin> peers;
+
+        // Status generation of torrent plugin when snapshot was taken
+        uint64_t generation;
+    };
+
+    // Latencies of all requests of a given type processed by plugin
+    struct RequestLatency {
+
+        RequestLatency() {}
+
+        // Name of request type, e.g. "Start"
+        std::string requestType;
+
+        // Time from Plugin::submit() until request was taken off queue
+        LatencyHistogram queueWait;
+
+        // Time spent processing request, including posting of result
+        LatencyHistogram execution;
+    };
+
+    // Time spent on extended messages of a given type by network thread
+    struct MessageLatency {
+
+        MessageLatency() {}
+
+        // Name of message type, see getMessageName
+        std::string messageType;
+
+        // Decoding received message
+        LatencyHistogram parse;
+
+        // Processing of decoded message by session
+        LatencyHistogram dispatch;
+
+        // Encoding message and handing it to connection
+        LatencyHistogram send;
     };
 
 }
@@ -0,0 +1,63 @@
+/**
+ * Copyright (C) JoyStream - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#ifndef JOYSTREAM_EXTENSION_STOPWATCH_HPP
+#define JOYSTREAM_EXTENSION_STOPWATCH_HPP
+
+#include <extension/LatencyHistogram.hpp>
+
+#include <chrono>
+
+namespace joystream {
+namespace extension {
+
+// Times consecutive phases of work on the network thread, e.g. parsing and then
+// dispatching an extended message. When built with JOYSTREAM_EXTENSION_DISABLE_MESSAGE_TIMING
+// defined, it is empty and all calls compile away, while histograms remain in place.
+#ifndef JOYSTREAM_EXTENSION_DISABLE_MESSAGE_TIMING
+
+class Stopwatch {
+
+public:
+
+    static constexpr bool enabled = true;
+
+    Stopwatch()
+        : _start(std::chrono::steady_clock::now()) {
+    }
+
+    // Records time since construction or last lap in histogram, and starts next lap
+    void lap(LatencyHistogram & histogram) {
+
+        const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+        histogram.record(now - _start);
+
+        _start = now;
+    }
+
+private:
+
+    std::chrono::steady_clock::time_point _start;
+};
+
+#else
+
+class Stopwatch {
+
+public:
+
+    static constexpr bool enabled = false;
+
+    void lap(LatencyHistogram &) {}
+};
+
+#endif
+
+}
+}
+
+#endif // JOYSTREAM_EXTENSION_STOPWATCH_HPP
@@ -9,17 +9,26 @@
 #define JOYSTREAM_EXTENSION_TORRENTPLUGIN_HPP
 
 #include <extension/PeerPlugin.hpp>
+#include <extension/Logger.hpp>
 #include <protocol_session/protocol_session.hpp>
 #include <libtorrent/extensions.hpp>
 #include <libtorrent/torrent.hpp>
 #include <libtorrent/alert_types.hpp>
 #include <map>
 #include <chrono>
+#include <memory>
+#include <functional>
+#include <boost/optional.hpp>
 
 namespace joystream {
 namespace extension {
 namespace status {
     struct TorrentPlugin;
+    struct PeerPlugin;
+    struct TorrentPluginSnapshot;
+    struct MessageLatency;
+    struct PeerEvents;
+    struct ColumnarStatus;
 }
 
 class Plugin;
@@ -30,10 +39,21 @@ public:
 
     struct Policy {
 
+        // Per peer event alerts which can be aggregated into alert::AggregatedPeerEventsAlert
+        enum AggregatedAlert {
+            ConnectionAddedToSession = 1,
+            ValidPaymentReceived = 2,
+            SentPayment = 4,
+            ValidPieceArrived = 8,
+            AllAggregatedAlerts = 15
+        };
+
         Policy(bool banPeersWithPastMalformedExtendedMessage,
                bool banPeersWithPastMisbehavior)
             : banPeersWithPastMalformedExtendedMessage(banPeersWithPastMalformedExtendedMessage)
-            , banPeersWithPastMisbehavior(banPeersWithPastMisbehavior) {
+            , banPeersWithPastMisbehavior(banPeersWithPastMisbehavior)
+            , aggregatedAlerts(0)
+            , alertAggregationInterval(1000) {
         }
 
         Policy() : Policy(true, true) { }
@@ -45,6 +65,63 @@ public:
         // Should TorrenPlugin::new_connection accept a peer which
         // is known to have misbehaved prior.
         bool banPeersWithPastMisbehavior;
+
+        // Bitmask of AggregatedAlert, selected alerts are not posted per event,
+        // but summarized per peer in alert::AggregatedPeerEventsAlert,
+        // zero means no aggregation
+        int aggregatedAlerts;
+
+        // How often alert::AggregatedPeerEventsAlert is posted, checked on tick.
+        // Pending events are also posted when the session is stopped, when a
+        // connection is removed from session, and when the torrent plugin is
+        // destroyed, i.e. on torrent removal or session teardown.
+        std::chrono::milliseconds alertAggregationInterval;
+    };
+
+    // Selects peer plugins, and fields, when generating their statuses
+    struct PeerStatusQuery {
+
+        // Optional parts of status::PeerPlugin, which are costly to generate
+        enum Field : unsigned int {
+
+            // status::PeerPlugin::connection
+            ConnectionStatus = 1 << 0,
+
+            All = ConnectionStatus
+        };
+
+        PeerStatusQuery()
+            : inSessionOnly(false)
+            , maxCount(0)
+            , fields(All) {
+        }
+
+        // Whether query matches all peers with all fields, the default
+        bool unfiltered() const {
+            return !inSessionOnly && !peerBEP10SupportStatus && !peerPaymentBEPSupportStatus &&
+                   !connectionFilter && !cursor && maxCount == 0 && fields == All;
+        }
+
+        // Only peers with a connection in session
+        bool inSessionOnly;
+
+        // Only peers with given support, when set
+        boost::optional<BEPSupportStatus> peerBEP10SupportStatus;
+        boost::optional<BEPSupportStatus> peerPaymentBEPSupportStatus;
+
+        // Only peers with a connection in session, for which this returns true, when set.
+        // Connection status is generated to evaluate it, regardless of ::fields.
+        std::function<bool(const protocol_session::status::Connection<libtorrent::peer_id> &)> connectionFilter;
+
+        // Peers are visited in order of peer id, starting
+        // right after this one when set, see ::peerStatuses
+        boost::optional<libtorrent::peer_id> cursor;
+
+        // Maximum number of statuses, zero is no limit
+        std::size_t maxCount;
+
+        // Mask of Field values to include
+        unsigned int fields;
     };
 
     // How this plugin shuold interact with libtorrent events
@@ -145,6 +222,34 @@ public:
 
     status::TorrentPlugin status() const;
 
+    // Plugin wide generation of last change to status, see request::PostTorrentPluginStatusUpdates
+    uint64_t statusGeneration() const noexcept;
+
+    // Status of peer plugins which have completed handshake, and match query.
+    // If given, nextCursor is set to cursor for next page when maxCount cut
+    // statuses short, and is unset otherwise.
+    std::map<libtorrent::peer_id, status::PeerPlugin> peerStatuses(const PeerStatusQuery & query = PeerStatusQuery(),
+                                                                   boost::optional<libtorrent::peer_id> * nextCursor = nullptr) const;
+
+    // Appends row with status of plugin to torrent columns, and
+    // rows of peer plugins which completed handshake to peer columns
+    void exportStatus(status::ColumnarStatus &, const std::chrono::steady_clock::time_point & now) const;
+
+    // Latest status snapshot published by torrent plugin, which is shared
+    // with Plugin, where it is read from any thread. Snapshot must only
+    // be accessed through std::atomic_load and std::atomic_store, snapshot is
+    // built before it is stored, so readers only contend on the pointer copy.
+    struct PublishedStatus {
+        std::shared_ptr<const status::TorrentPluginSnapshot> snapshot;
+    };
+
+    const std::shared_ptr<PublishedStatus> & publishedStatus() const noexcept;
+
+    // Publishes snapshot of torrent and peer plugin statuses, unless
+    // nothing has changed since last time. Is called on each tick, and
+    // after processing requests, so peer changes may be up to a tick old.
+    void publishStatus();
+
     LibtorrentInteraction libtorrentInteraction() const;
 
     void setLibtorrentInteraction(LibtorrentInteraction);
@@ -189,22 +294,49 @@ private:
 
     int pickNextPiece(const std::vector<protocol_session::detail::Piece<libtorrent::peer_id>> * pieces);
 
+    // Records that status may have changed, is called after any session
+    // call or event which may alter what ::status() returns
+    void markStatusChanged();
+
+    // Counters of parent plugin
+    Metrics & metrics() const;
+
+    // Send buffers of parent plugin
+    SendBufferPool & sendBufferPool() const;
+
+    // Latency statistics of parent plugin for given type of extended message
+    status::MessageLatency & messageLatency(MessageType) const;
+
+    // Whether given alert is aggregated, rather than posted per event
+    bool aggregates(Policy::AggregatedAlert) const;
+
+    // Aggregated events of given peer since last alert::AggregatedPeerEventsAlert
+    status::PeerEvents & aggregatedEvents(const libtorrent::peer_id &, const libtorrent::tcp::endpoint &);
+
+    // Posts alert::AggregatedPeerEventsAlert with any aggregated events
+    void postAggregatedEvents();
+
+    // Records paid transfer, over some connection, in torrent and plugin totals
+    void transferred(TransferEvent, uint64_t amount, const std::chrono::steady_clock::time_point & now);
+
     // Processes extended message from peer
     template<class M>
     void processExtendedMessage(PeerPlugin* peerPlugin, const M &extendedMessage){
         if(_session.mode() == protocol_session::SessionMode::not_set) {
-            std::clog << "Ignoring extended message - session mode not set" << std::endl;
+            JOYSTREAM_EXTENSION_LOG(Warning, "Ignoring extended message - session mode not set");
             return;
         }
 
         if(!peerInSession(peerPlugin)) {
-            std::clog << "Ignoring extended message - connection already removed from session" << std::endl;
+            JOYSTREAM_EXTENSION_LOG(Warning, "Ignoring extended message - connection already removed from session");
             return;
         }
 
         // Have session process message
         auto peerId = peerPlugin->connection().pid();
         _session.processMessageOnConnection<M>(peerId, extendedMessage);
+
+        markStatusChanged();
     }
 
     /// Protocol session hooks
@@ -284,6 +416,21 @@ private:
     // the session again, the client side will reinvite peer to do extended handshake
     protocol_session::Session<libtorrent::peer_id> _session;
 
+    // Plugin wide generation of last change to status
+    uint64_t _statusGeneration;
+
+    // Latest published status, and generation it was taken at
+    std::shared_ptr<PublishedStatus> _publishedStatus;
+    uint64_t _publishedStatusGeneration;
+
+    // Events aggregated since last alert::AggregatedPeerEventsAlert,
+    // and when next such alert is due
+    std::map<libtorrent::peer_id, status::PeerEvents> _aggregatedEvents;
+    std::chrono::steady_clock::time_point _nextAggregatedEventsAlert;
+
+    // Paid transfers over all connections, also past ones
+    TransferAccounting _transfer;
+
     /**
      * Hopefully we can ditch all of this, if we can delete connections in new_connection callback
      *
@@ -0,0 +1,136 @@
+/**
+ * Copyright (C) JoyStream - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#ifndef JOYSTREAM_EXTENSION_TRANSFER_HPP
+#define JOYSTREAM_EXTENSION_TRANSFER_HPP
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+
+namespace joystream {
+namespace extension {
+namespace status {
+
+    // Total, and exponentially weighted rate per second, of one kind of transfer
+    struct TransferFlow {
+
+        TransferFlow()
+            : count(0)
+            , amount(0)
+            , countRate(0)
+            , amountRate(0) {
+        }
+
+        TransferFlow & operator+=(const TransferFlow & o) {
+            count += o.count;
+            amount += o.amount;
+            countRate += o.countRate;
+            amountRate += o.amountRate;
+            return *this;
+        }
+
+        // Number of transfers, e.g. pieces
+        uint64_t count;
+
+        // Sum of transfers, bytes for pieces and satoshis for payments
+        uint64_t amount;
+
+        double countRate;
+        double amountRate;
+    };
+
+    // Paid transfers over connection(s)
+    struct Transfer {
+
+        Transfer() {}
+
+        Transfer & operator+=(const Transfer & o) {
+            piecesSent += o.piecesSent;
+            piecesReceived += o.piecesReceived;
+            paymentsSent += o.paymentsSent;
+            paymentsReceived += o.paymentsReceived;
+            return *this;
+        }
+
+        // Full piece messages, amount in bytes
+        TransferFlow piecesSent;
+        TransferFlow piecesReceived;
+
+        // Valid payments, amount in satoshis
+        TransferFlow paymentsSent;
+        TransferFlow paymentsReceived;
+    };
+}
+
+enum class TransferEvent {
+    PieceSent,
+    PieceReceived,
+    PaymentSent,
+    PaymentReceived
+};
+
+// Exponentially weighted moving rate of events, each amount
+// decays with exp(-age/timeConstant).
+class RateEstimator {
+
+public:
+
+    RateEstimator();
+
+    void add(double amount, const std::chrono::steady_clock::time_point & now);
+
+    // Per second
+    double rate(const std::chrono::steady_clock::time_point & now) const;
+
+private:
+
+    double _rate;
+
+    std::chrono::steady_clock::time_point _updated;
+};
+
+// Totals and rates of paid transfers, kept per peer plugin, torrent plugin and plugin.
+// Only used on network thread.
+class TransferAccounting {
+
+public:
+
+    // How quickly rates forget past transfers
+    static constexpr double timeConstant = 10; // seconds
+
+    TransferAccounting() {}
+
+    void record(TransferEvent, uint64_t amount, const std::chrono::steady_clock::time_point & now);
+
+    status::Transfer status(const std::chrono::steady_clock::time_point & now) const;
+
+private:
+
+    struct Flow {
+
+        Flow()
+            : count(0)
+            , amount(0) {
+        }
+
+        uint64_t count;
+        uint64_t amount;
+
+        RateEstimator countRate;
+        RateEstimator amountRate;
+    };
+
+    status::TransferFlow status(const Flow &, const std::chrono::steady_clock::time_point & now) const;
+
+    std::array<Flow, 4> _flows;
+};
+
+}
+}
+
+#endif // JOYSTREAM_EXTENSION_TRANSFER_HPP
@@ -12,9 +12,14 @@
 #include <extension/Request.hpp>
 
 #include <boost/variant.hpp>
+#include <boost/mpl/size.hpp>
 
 #include <exception>
 #include <functional>
+#include <vector>
+#include <chrono>
+#include <future>
+#include <memory>
 
 namespace joystream {
 namespace extension {
@@ -25,6 +30,8 @@ namespace detail {
 
 typedef std::char_traits<char>::int_type int_type;
 
+struct RequestBatch;
+
 // Variant used to allow a single request queue
 typedef boost::variant<request::Start,
                        request::Stop,
@@ -36,6 +43,9 @@ typedef boost::variant<request::Start,
                        request::ToBuyMode,
                        request::PostTorrentPluginStatusUpdates,
                        request::PostPeerPluginStatusUpdates,
+                       request::PostRequestLatencyStatistics,
+                       request::PostMessageLatencyStatistics,
+                       request::ExportStatus,
                        request::StopAllTorrentPlugins,
                        request::PauseLibtorrent,
                        request::AddTorrent,
@@ -45,44 +55,189 @@ typedef boost::variant<request::Start,
                        request::StartDownloading,
                        request::StartUploading,
                        request::SetLibtorrentInteraction,
-                       request::DropPeer> RequestVariant;
+                       request::DropPeer,
+                       boost::recursive_wrapper<RequestBatch> > RequestVariant;
+
+// Requests submitted together with Plugin::submitBatch, are processed in
+// one go, and completed with a single alert::BatchRequestResult
+struct RequestBatch {
+
+    RequestBatch(std::vector<RequestVariant> requests, const request::BatchHandler & handler)
+        : requests(std::move(requests))
+        , handler(handler) {
+    }
+
+    std::vector<RequestVariant> requests;
+    request::BatchHandler handler;
+};
+
+// Entry in request queue
+struct QueuedRequest {
+
+    QueuedRequest() {}
+
+    template<class T>
+    QueuedRequest(const std::chrono::steady_clock::time_point & submitted, T && request, const request::Executor & executor)
+        : request(std::forward<T>(request))
+        , submitted(submitted)
+        , executor(executor) {
+    }
+
+    RequestVariant request;
+
+    // When request was submitted
+    std::chrono::steady_clock::time_point submitted;
+
+    // Runs completion of request, if not set, completion is posted as alert
+    request::Executor executor;
+};
+
+// Handlers resolving a promise, used by Plugin::submitWithFuture. They run
+// on network thread, so they only fulfil promise, and run no caller code.
+
+template<class Handler>
+struct FutureResult;
+
+template<>
+struct FutureResult<request::SubroutineHandler> { typedef void type; };
+
+template<>
+struct FutureResult<request::NoExceptionSubroutineHandler> { typedef void type; };
+
+template<>
+struct FutureResult<request::AddTorrent::AddTorrentHandler> { typedef libtorrent::torrent_handle type; };
+
+template<>
+struct FutureResult<request::ExportStatus::ExportStatusHandler> { typedef std::shared_ptr<status::ColumnarStatus> type; };
+
+inline request::SubroutineHandler resolving(const std::shared_ptr<std::promise<void> > & promise, const request::SubroutineHandler &) {
+
+    return [promise](const std::exception_ptr & e) {
+
+        if(e)
+            promise->set_exception(e);
+        else
+            promise->set_value();
+    };
+}
+
+inline request::NoExceptionSubroutineHandler resolving(const std::shared_ptr<std::promise<void> > & promise, const request::NoExceptionSubroutineHandler &) {
+
+    return [promise]() {
+        promise->set_value();
+    };
+}
 
+inline request::AddTorrent::AddTorrentHandler resolving(const std::shared_ptr<std::promise<libtorrent::torrent_handle> > & promise, const request::AddTorrent::AddTorrentHandler &) {
+
+    return [promise](libtorrent::error_code & ec, libtorrent::torrent_handle & h) {
+
+        if(ec)
+            promise->set_exception(std::make_exception_ptr(libtorrent::system_error(ec)));
+        else
+            promise->set_value(h);
+    };
+}
+
+inline request::ExportStatus::ExportStatusHandler resolving(const std::shared_ptr<std::promise<std::shared_ptr<status::ColumnarStatus> > > & promise, const request::ExportStatus::ExportStatusHandler &) {
+
+    return [promise](const std::shared_ptr<status::ColumnarStatus> & columns) {
+        promise->set_value(columns);
+    };
+}
+
+// Executor running completion directly on network thread
+inline void runInline(std::function<void()> completion) {
+    completion();
+}
+
+// Number of types of request in RequestVariant
+static const int numberOfRequestTypes = boost::mpl::size<RequestVariant::types>::value;
+
+// Name of type of request held by variant
+const char * requestTypeName(const RequestVariant &);
+
+// Info hash of torrent which request held by variant is limited to,
+// or nullptr if it is not a torrent scoped request.
+const libtorrent::sha1_hash * requestTorrent(const RequestVariant &);
+
+// Collects results of requests in a batch, rather than having
+// a RequestResult alert posted for each one
+struct BatchResultCollector {
+
+    // Bound handlers of individual requests
+    std::vector<alert::LoadedCallback> callbacks;
+
+    // Outcome of each request, in order
+    std::vector<std::exception_ptr> results;
+};
+
+// Visitor applied to requests taken off the request queue.
+// Requests are visited by non-const reference, since each request
+// is visited exactly once, allowing handlers and payloads to be moved
+// rather than copied.
 class RequestVariantVisitor : public boost::static_visitor<> {
 
 public:
 
     RequestVariantVisitor(Plugin * plugin,
                           libtorrent::aux::session_impl * session,
-                          libtorrent::alert_manager * alertManager)
+                          libtorrent::alert_manager * alertManager,
+                          BatchResultCollector * batchResultCollector = nullptr)
         : _plugin(plugin)
         , _session(session)
-        , _alertManager(alertManager) {}
-
-    void operator()(const request::Start & r);
-    void operator()(const request::Stop & r);
-    void operator()(const request::Pause & r);
-    void operator()(const request::UpdateBuyerTerms & r);
-    void operator()(const request::UpdateSellerTerms & r);
-    void operator()(const request::ToObserveMode & r);
-    void operator()(const request::ToSellMode & r);
-    void operator()(const request::ToBuyMode & r);
-    void operator()(const request::PostTorrentPluginStatusUpdates & r);
-    void operator()(const request::PostPeerPluginStatusUpdates & r);
-    void operator()(const request::StopAllTorrentPlugins & r);
-    void operator()(const request::PauseLibtorrent & r);
-    void operator()(const request::AddTorrent & r);
-    void operator()(const request::RemoveTorrent & r);
-    void operator()(const request::PauseTorrent & r);
-    void operator()(const request::ResumeTorrent & r);
-    void operator()(const request::StartDownloading & r);
-    void operator()(const request::StartUploading & r);
-    void operator()(const request::SetLibtorrentInteraction &r);
-    void operator()(const request::DropPeer &r);
+        , _alertManager(alertManager)
+        , _batchResultCollector(batchResultCollector)
+        , _executor(nullptr) {}
+
+    void operator()(request::Start & r);
+    void operator()(request::Stop & r);
+    void operator()(request::Pause & r);
+    void operator()(request::UpdateBuyerTerms & r);
+    void operator()(request::UpdateSellerTerms & r);
+    void operator()(request::ToObserveMode & r);
+    void operator()(request::ToSellMode & r);
+    void operator()(request::ToBuyMode & r);
+    void operator()(request::PostTorrentPluginStatusUpdates & r);
+    void operator()(request::PostPeerPluginStatusUpdates & r);
+    void operator()(request::PostRequestLatencyStatistics & r);
+    void operator()(request::PostMessageLatencyStatistics & r);
+    void operator()(request::ExportStatus & r);
+    void operator()(request::StopAllTorrentPlugins & r);
+    void operator()(request::PauseLibtorrent & r);
+    void operator()(request::AddTorrent & r);
+    void operator()(request::RemoveTorrent & r);
+    void operator()(request::PauseTorrent & r);
+    void operator()(request::ResumeTorrent & r);
+    void operator()(request::StartDownloading & r);
+    void operator()(request::StartUploading & r);
+    void operator()(request::SetLibtorrentInteraction &r);
+    void operator()(request::DropPeer &r);
+    void operator()(RequestBatch & r);
+
+    // Executor for completion of next request visited,
+    // if null or empty completion is posted as alert.
+    void setExecutor(const request::Executor * executor) { _executor = executor; }
 
 private:
 
-    //
-    void sendRequestResult(const alert::LoadedCallback &);
+    // Posts result of request, or collects it if request is part of a batch
+    void sendRequestResult(alert::LoadedCallback &&, const std::exception_ptr & e = std::exception_ptr());
+
+    // Hands completion to executor, which is caller code, so whatever it
+    // throws is logged rather than unwinding the network thread
+    void execute(alert::LoadedCallback &&);
+
+    // Completion running handler with given arguments, empty if handler is not set,
+    // as is common for requests in a batch, which then skips it
+    template<class Handler, class... Args>
+    static alert::LoadedCallback bindHandler(Handler && handler, Args &&... args) {
+
+        if(!handler)
+            return alert::LoadedCallback();
+
+        return std::bind(std::forward<Handler>(handler), std::forward<Args>(args)...);
+    }
 
     //
     std::exception_ptr runTorrentPluginRequest(const libtorrent::sha1_hash &,
@@ -95,6 +250,12 @@ private:
 
     // Alert manager for posting messages
     libtorrent::alert_manager * _alertManager;
+
+    // Is set when visiting requests in a batch
+    BatchResultCollector * _batchResultCollector;
+
+    // Is set when request being visited has its own executor
+    const request::Executor * _executor;
 };
 
 
@@ -17,10 +17,18 @@ size_t hash<libtorrent::tcp::endpoint>::operator()(const libtorrent::tcp::endpoi
 }
 
 // hash<libtorrent::peer_id> needed for std::unordered_map with this template key
+// is also used for info hashes, so all bytes are mixed, as peer ids start with a client prefix.
+// FNV-1a, avoids formatting and allocating a hex string for every lookup.
 size_t hash<libtorrent::peer_id>::operator()(const libtorrent::peer_id & peerId) const {
-    char hex[41];
-    libtorrent::to_hex(reinterpret_cast<char const*>(&peerId[0]), libtorrent::sha1_hash::size, hex);
-    return std::hash<std::string>{}(hex);
+
+    uint64_t h = 14695981039346656037ULL;
+
+    for(int i = 0;i < libtorrent::sha1_hash::size;i++) {
+        h ^= static_cast<unsigned char>(peerId[i]);
+        h *= 1099511628211ULL;
+    }
+
+    return static_cast<size_t>(h);
 }
 
 }
@@ -6,12 +6,16 @@ namespace joystream {
 namespace extension {
 
 // Construtctor for creating a new extended message
-ExtendedMessage::ExtendedMessage(size_t payloadSize, uint8_t messageId):
-    _size(payloadSize + headerSize),
-    _extendedMessageBuffer(new char[_size]),
-    _payloadBuffer(&_extendedMessageBuffer[headerSize], &_extendedMessageBuffer[0] + _size) {
+ExtendedMessage::ExtendedMessage(size_t payloadSize, uint8_t messageId, SendBufferPool & pool)
+    : ExtendedMessage(payloadSize, payloadSize, messageId, pool) {
+}
+
+ExtendedMessage::ExtendedMessage(size_t payloadSize, size_t bufferedPayloadSize, uint8_t messageId, SendBufferPool & pool):
+    _size(bufferedPayloadSize + headerSize),
+    _extendedMessageBuffer(pool.acquire(_size)),
+    _payloadBuffer(_extendedMessageBuffer.data() + headerSize, _extendedMessageBuffer.data() + _size) {
 
-    auto header_begin = &_extendedMessageBuffer[0];
+    auto header_begin = _extendedMessageBuffer.data();
     auto header_end = header_begin + headerSize;
 
     char_array_buffer headerBuffer(header_begin, header_end);
@@ -37,9 +41,13 @@ std::streambuf* ExtendedMessage::payloadBuf() {
     return &_payloadBuffer;
 }
 
+char * ExtendedMessage::payload() {
+    return _extendedMessageBuffer.data() + headerSize;
+}
+
 void ExtendedMessage::send(libtorrent::peer_connection_handle &connection) {
     // Send message buffer
-    connection.send_buffer(&_extendedMessageBuffer[0], _size);
+    connection.send_buffer(_extendedMessageBuffer.data(), _size);
 }
 
 }
@@ -28,7 +28,12 @@ namespace extension {
         MessageType::speedTestPayload
     };
 
-    ExtendedMessageIdMapping::ExtendedMessageIdMapping() {
+    const uint8_t ExtendedMessageIdMapping::noMessageType;
+
+    ExtendedMessageIdMapping::ExtendedMessageIdMapping()
+        : _empty(true) {
+        _ids.fill(0);
+        _messageTypes.fill(noMessageType);
     }
 
     ExtendedMessageIdMapping::ExtendedMessageIdMapping(const ExtendedMessageIdMapping & arg) {
@@ -37,8 +42,10 @@ namespace extension {
 
     ExtendedMessageIdMapping & ExtendedMessageIdMapping::operator=(const ExtendedMessageIdMapping & rhs) {
 
-        // Copy underlying MessageToIdMapping
-        _mapping = rhs._mapping;
+        // Copy underlying tables
+        _empty = rhs._empty;
+        _ids = rhs._ids;
+        _messageTypes = rhs._messageTypes;
 
         // Return self reference
         return *this;
@@ -46,6 +53,21 @@ namespace extension {
 
     ExtendedMessageIdMapping ExtendedMessageIdMapping::fromMDictionary(const libtorrent::bdecode_node & m) {
 
+        boost::optional<exception::InvalidMessageMappingDictionary::Problem> problem;
+
+        ExtendedMessageIdMapping mapping = fromMDictionary(m, problem);
+
+        if(problem)
+            throw exception::InvalidMessageMappingDictionary(*problem);
+
+        return mapping;
+    }
+
+    ExtendedMessageIdMapping ExtendedMessageIdMapping::fromMDictionary(const libtorrent::bdecode_node & m,
+                                                                       boost::optional<exception::InvalidMessageMappingDictionary::Problem> & problem) {
+
+        problem = boost::none;
+
         RawMapping mapping;
 
         // Length of prefix for "originating client" for this extension
@@ -65,7 +87,7 @@ namespace extension {
 
             // Each message name has to have prefix CLIENT_PREFIX_STRING,
             // otherwise it is not for this extension.
-            if(key.length() <= clientPrefixLength)
+            if(key.length() <= clientPrefixLength || key.compare(0, clientPrefixLength, CLIENT_PREFIX_STRING) != 0)
                 continue;
 
             // Try to convert string to message type
@@ -86,10 +108,11 @@ namespace extension {
             // Try to get value, skip if its not an integer
             libtorrent::bdecode_node::type_t valueType = pair.second.type();
 
-            // Throw exception if its not
+            // Fail if its not
             if(valueType != libtorrent::bdecode_node::int_t) {
 
-                throw exception::InvalidMessageMappingDictionary(exception::InvalidMessageMappingDictionary::Problem::MessageMapsToInvalidValueTypeException);
+                problem = exception::InvalidMessageMappingDictionary::Problem::MessageMapsToInvalidValueTypeException;
+                return ExtendedMessageIdMapping();
 
 //                exception::MessageMapsToInvalidValueTypeException::FoundType type;
 
@@ -105,9 +128,10 @@ namespace extension {
             boost::int64_t value = pair.second.int_value();
 
             // Make sure id is non-negative
-            if(value < 0)
-                throw exception::InvalidMessageMappingDictionary(exception::InvalidMessageMappingDictionary::Problem::MessageIdNegativeException); //throw exception::MessageIdNegativeException(message, value);
-            else if(value == 0)
+            if(value < 0) {
+                problem = exception::InvalidMessageMappingDictionary::Problem::MessageIdNegativeException; //throw exception::MessageIdNegativeException(message, value);
+                return ExtendedMessageIdMapping();
+            } else if(value == 0)
                 atLeastOneIdIsZero = true;
             else// value 1 >= 0
                 allIdsToZero = false;
@@ -116,16 +140,22 @@ namespace extension {
             mapping[message] = (uint8_t)value;
         }
 
-        // Check if all messages are represented (just check size): if not throw error about it
-        if(mapping.size() != ExtendedMessageIdMapping::messages.size())
-            throw exception::InvalidMessageMappingDictionary(exception::InvalidMessageMappingDictionary::Problem::IncompleteMessageSet);// throw exception::IncompleteMessageSet();
+        // Check if all messages are represented (just check size): if not fail
+        if(mapping.size() != ExtendedMessageIdMapping::messages.size()) {
+            problem = exception::InvalidMessageMappingDictionary::Problem::IncompleteMessageSet;// throw exception::IncompleteMessageSet();
+            return ExtendedMessageIdMapping();
+        }
 
-        // Check if all map to 0: throw exception about this being an uninstall
-        if(allIdsToZero)
-            throw exception::InvalidMessageMappingDictionary(exception::InvalidMessageMappingDictionary::Problem::UninstallMappingFound); //throw exception::UninstallMappingFound();
+        // Check if all map to 0: report this being an uninstall
+        if(allIdsToZero) {
+            problem = exception::InvalidMessageMappingDictionary::Problem::UninstallMappingFound; //throw exception::UninstallMappingFound();
+            return ExtendedMessageIdMapping();
+        }
 
-        if(atLeastOneIdIsZero)
-            throw exception::InvalidMessageMappingDictionary(exception::InvalidMessageMappingDictionary::Problem::ZeroIdInvalidOnNonUninstallMapping); //throw exception::ZeroIdInvalidOnNonUninstallMapping();
+        if(atLeastOneIdIsZero) {
+            problem = exception::InvalidMessageMappingDictionary::Problem::ZeroIdInvalidOnNonUninstallMapping; //throw exception::ZeroIdInvalidOnNonUninstallMapping();
+            return ExtendedMessageIdMapping();
+        }
 
         assert(mapping.size() == messages.size());
 
@@ -161,17 +191,15 @@ namespace extension {
         if(empty())
             throw exception::InvalidOperationOnEmptyMappingException();
 
-        assert(_mapping.size() == messages.size());
-
-        writeMappingToMDictionary(_mapping, m);
+        writeMappingToMDictionary(rawMapping(), m);
     }
 
     bool ExtendedMessageIdMapping::empty() const {
-        return _mapping.empty();
+        return _empty;
     }
 
     void ExtendedMessageIdMapping::clear() {
-        _mapping.clear();
+        *this = ExtendedMessageIdMapping();
     }
 
     uint8_t ExtendedMessageIdMapping::id(MessageType messageType) const {
@@ -179,9 +207,7 @@ namespace extension {
         if(empty())
             throw exception::InvalidOperationOnEmptyMappingException();
 
-        assert(_mapping.size() == messages.size());
-
-        return _mapping.find(messageType)->second;
+        return _ids[static_cast<std::size_t>(messageType)];
     }
 
     MessageType ExtendedMessageIdMapping::messageType(uint8_t id) const {
@@ -189,18 +215,34 @@ namespace extension {
         if(empty())
             throw exception::InvalidOperationOnEmptyMappingException();
 
-        assert(_mapping.size() == messages.size());
+        const uint8_t messageType = _messageTypes[id];
 
-        for(auto i : _mapping) {
+        // There was not message with the given id
+        if(messageType == noMessageType)
+            throw exception::InvalidMessageMappingDictionary(exception::InvalidMessageMappingDictionary::Problem::NoSuchIdException); // throw exception::NoSuchIdException();
 
-            // By the assumption that this is a valid mapping,
-            // we can't be sure that a match is the only match.
-            if(i.second == id)
-                return i.first;
-        }
+        return static_cast<MessageType>(messageType);
+    }
 
-        // There was not message with the given id
-        throw exception::InvalidMessageMappingDictionary(exception::InvalidMessageMappingDictionary::Problem::NoSuchIdException); // throw exception::NoSuchIdException();
+    boost::optional<MessageType> ExtendedMessageIdMapping::tryMessageType(uint8_t id) const {
+
+        // Tables of empty mapping have no messages
+        const uint8_t messageType = _messageTypes[id];
+
+        if(messageType == noMessageType)
+            return boost::none;
+
+        return static_cast<MessageType>(messageType);
+    }
+
+    ExtendedMessageIdMapping::RawMapping ExtendedMessageIdMapping::rawMapping() const {
+
+        RawMapping mapping;
+
+        for(auto message : messages)
+            mapping.insert(std::make_pair(message, _ids[static_cast<std::size_t>(message)]));
+
+        return mapping;
     }
 
     void ExtendedMessageIdMapping::writeMappingToMDictionary(const RawMapping & mapping, libtorrent::entry::dictionary_type & m) {
@@ -220,7 +262,24 @@ namespace extension {
     }
 
     ExtendedMessageIdMapping::ExtendedMessageIdMapping(const RawMapping & mapping)
-        : _mapping(mapping) {
+        : ExtendedMessageIdMapping() {
+
+        // Only complete mappings are created
+        assert(mapping.size() == messages.size());
+        assert(messages.size() == numberOfMessageTypes);
+
+        _empty = false;
+
+        // Iterated in order of MessageType, so lowest message wins a shared id
+        for(auto i : mapping) {
+
+            const uint8_t messageType = static_cast<uint8_t>(i.first);
+
+            _ids[messageType] = i.second;
+
+            if(_messageTypes[i.second] == noMessageType)
+                _messageTypes[i.second] = messageType;
+        }
     }
 
 }
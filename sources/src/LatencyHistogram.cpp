@@ -0,0 +1,137 @@
+/**
+ * Copyright (C) JoyStream - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#include <extension/LatencyHistogram.hpp>
+
+#include <algorithm>
+#include <limits>
+
+namespace joystream {
+namespace extension {
+
+LatencyHistogram::LatencyHistogram() {
+    clear();
+}
+
+void LatencyHistogram::record(const std::chrono::nanoseconds & duration) {
+
+    const uint64_t value = duration.count() < 0 ? 0 : static_cast<uint64_t>(duration.count());
+
+    _buckets[bucketIndex(value)]++;
+
+    _count++;
+    _total += value;
+    _min = std::min(_min, value);
+    _max = std::max(_max, value);
+}
+
+void LatencyHistogram::add(const LatencyHistogram & other) {
+
+    for(int i = 0;i < bucketCount;i++)
+        _buckets[i] += other._buckets[i];
+
+    _count += other._count;
+    _total += other._total;
+    _min = std::min(_min, other._min);
+    _max = std::max(_max, other._max);
+}
+
+void LatencyHistogram::clear() {
+
+    _buckets.fill(0);
+    _count = 0;
+    _total = 0;
+    _min = std::numeric_limits<uint64_t>::max();
+    _max = 0;
+}
+
+uint64_t LatencyHistogram::count() const noexcept {
+    return _count;
+}
+
+std::chrono::nanoseconds LatencyHistogram::min() const noexcept {
+    return std::chrono::nanoseconds(_count == 0 ? 0 : _min);
+}
+
+std::chrono::nanoseconds LatencyHistogram::max() const noexcept {
+    return std::chrono::nanoseconds(_max);
+}
+
+std::chrono::nanoseconds LatencyHistogram::mean() const noexcept {
+    return std::chrono::nanoseconds(_count == 0 ? 0 : _total / _count);
+}
+
+std::chrono::nanoseconds LatencyHistogram::percentile(double p) const noexcept {
+
+    if(_count == 0)
+        return std::chrono::nanoseconds(0);
+
+    p = std::max(0.0, std::min(100.0, p));
+
+    // Rank of value sought, counting from 1
+    const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(p / 100.0 * _count + 0.5));
+
+    uint64_t seen = 0;
+
+    for(int i = 0;i < bucketCount;i++) {
+
+        seen += _buckets[i];
+
+        // Never report beyond what was actually recorded
+        if(seen >= rank)
+            return std::chrono::nanoseconds(std::min(bucketUpperBound(i), _max));
+    }
+
+    return max();
+}
+
+uint64_t LatencyHistogram::bucket(int index) const noexcept {
+    return _buckets[index];
+}
+
+uint64_t LatencyHistogram::bucketLowerBound(int index) noexcept {
+
+    // Values below subBucketCount have a bucket each
+    if(index < subBucketCount)
+        return index;
+
+    const int offset = index - subBucketCount;
+    const int magnitude = offset / subBucketCount + subBucketBits;
+    const uint64_t subBucket = offset % subBucketCount;
+
+    return (uint64_t(1) << magnitude) + (subBucket << (magnitude - subBucketBits));
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(int index) noexcept {
+
+    if(index == bucketCount - 1)
+        return std::numeric_limits<uint64_t>::max();
+    else
+        return bucketLowerBound(index + 1) - 1;
+}
+
+int LatencyHistogram::bucketIndex(uint64_t value) noexcept {
+
+    if(value < static_cast<uint64_t>(subBucketCount))
+        return static_cast<int>(value);
+
+    // Position of highest set bit
+    int magnitude = 0;
+
+    for(uint64_t v = value;v > 1;v >>= 1)
+        magnitude++;
+
+    if(magnitude > maxMagnitude)
+        return bucketCount - 1;
+
+    // Bits following the highest set bit select linear sub-bucket
+    const int subBucket = static_cast<int>((value >> (magnitude - subBucketBits)) & (subBucketCount - 1));
+
+    return subBucketCount + (magnitude - subBucketBits) * subBucketCount + subBucket;
+}
+
+}
+}
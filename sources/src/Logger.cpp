@@ -0,0 +1,158 @@
+/**
+ * Copyright (C) JoyStream - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#include <extension/Logger.hpp>
+
+#include <iostream>
+#include <cassert>
+
+namespace joystream {
+namespace extension {
+
+const char * getLogLevelName(LogLevel level) {
+
+    switch(level) {
+        case LogLevel::Trace: return "trace";
+        case LogLevel::Debug: return "debug";
+        case LogLevel::Info: return "info";
+        case LogLevel::Warning: return "warning";
+        case LogLevel::Error: return "error";
+        case LogLevel::Off: return "off";
+    }
+
+    assert(false);
+    return "";
+}
+
+constexpr std::chrono::milliseconds Logger::drainInterval;
+
+Logger & Logger::instance() {
+
+    static Logger logger;
+
+    return logger;
+}
+
+Logger::Logger()
+    : _level(static_cast<int>(LogLevel::Info))
+    , _records(capacity)
+    , _dropped(0)
+    , _droppedUnreported(0)
+    , _stopping(false)
+    , _thread(&Logger::run, this) {
+}
+
+Logger::~Logger() {
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stopping = true;
+    }
+
+    _wakeUp.notify_one();
+
+    _thread.join();
+}
+
+void Logger::setLevel(LogLevel level) {
+    _level.store(static_cast<int>(level), std::memory_order_relaxed);
+}
+
+LogLevel Logger::level() const noexcept {
+    return static_cast<LogLevel>(_level.load(std::memory_order_relaxed));
+}
+
+void Logger::push(const LogRecord & record) {
+
+    if(!_records.tryPush(LogRecord(record))) {
+        _dropped.fetch_add(1, std::memory_order_relaxed);
+        _droppedUnreported.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void Logger::flush() {
+    drain();
+}
+
+uint64_t Logger::dropped() const noexcept {
+    return _dropped.load(std::memory_order_relaxed);
+}
+
+void Logger::run() {
+
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    while(!_stopping) {
+
+        lock.unlock();
+
+        drain();
+
+        lock.lock();
+
+        // Producers never notify, to keep push lock free, so poll
+        _wakeUp.wait_for(lock, drainInterval, [this] { return _stopping; });
+    }
+
+    lock.unlock();
+
+    // Write whatever was queued before shutdown
+    drain();
+}
+
+bool Logger::drain() {
+
+    std::lock_guard<std::mutex> lock(_drainMutex);
+
+    LogRecord record;
+    bool any = false;
+
+    while(_records.tryPop(record)) {
+
+        std::clog << '[' << getLogLevelName(record.level) << "] ";
+        std::clog.write(record.text, record.length);
+        std::clog << '\n';
+
+        any = true;
+    }
+
+    const uint64_t dropped = _droppedUnreported.exchange(0, std::memory_order_relaxed);
+
+    if(dropped > 0) {
+        std::clog << "[warning] " << dropped << " log records dropped, logger ring was full" << '\n';
+        any = true;
+    }
+
+    if(any)
+        std::clog.flush();
+
+    return any;
+}
+
+LogStatement::RecordBuffer::RecordBuffer(LogRecord & record) {
+    setp(record.text, record.text + LogRecord::maxLength);
+}
+
+std::size_t LogStatement::RecordBuffer::length() const {
+    return static_cast<std::size_t>(pptr() - pbase());
+}
+
+LogStatement::LogStatement(LogLevel level)
+    : _buffer(_record)
+    , _stream(&_buffer) {
+
+    _record.level = level;
+}
+
+LogStatement::~LogStatement() {
+
+    _record.length = _buffer.length();
+
+    Logger::instance().push(_record);
+}
+
+}
+}
@@ -0,0 +1,52 @@
+/**
+ * Copyright (C) JoyStream - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#include <extension/Metrics.hpp>
+
+namespace joystream {
+namespace extension {
+
+Metrics::Metrics()
+    : _malformedMessages(0)
+    , _peersBannedForMalformedMessages(0)
+    , _peersBannedForMisbehavior(0)
+    , _piecesLoaded(0)
+    , _pieceLoadFailures(0)
+    , _validPiecesArrived(0)
+    , _invalidPiecesArrived(0) {
+
+    for(std::atomic<uint64_t> & counter : _handshakes)
+        counter.store(0, std::memory_order_relaxed);
+}
+
+status::Metrics Metrics::snapshot() const {
+
+    status::Metrics metrics;
+
+    for(std::size_t i = 0;i < numberOfMessageTypes;i++) {
+        metrics.messages[i].sent = _messages[i].sent.load(std::memory_order_relaxed);
+        metrics.messages[i].sentBytes = _messages[i].sentBytes.load(std::memory_order_relaxed);
+        metrics.messages[i].received = _messages[i].received.load(std::memory_order_relaxed);
+        metrics.messages[i].receivedBytes = _messages[i].receivedBytes.load(std::memory_order_relaxed);
+    }
+
+    metrics.malformedMessages = _malformedMessages.load(std::memory_order_relaxed);
+
+    for(std::size_t i = 0;i < numberOfHandshakeOutcomes;i++)
+        metrics.handshakes[i] = _handshakes[i].load(std::memory_order_relaxed);
+
+    metrics.peersBannedForMalformedMessages = _peersBannedForMalformedMessages.load(std::memory_order_relaxed);
+    metrics.peersBannedForMisbehavior = _peersBannedForMisbehavior.load(std::memory_order_relaxed);
+    metrics.piecesLoaded = _piecesLoaded.load(std::memory_order_relaxed);
+    metrics.pieceLoadFailures = _pieceLoadFailures.load(std::memory_order_relaxed);
+    metrics.validPiecesArrived = _validPiecesArrived.load(std::memory_order_relaxed);
+    metrics.invalidPiecesArrived = _invalidPiecesArrived.load(std::memory_order_relaxed);
+
+    return metrics;
+}
+
+}
+}
@@ -6,6 +6,7 @@
  */
 
 #include <cassert>
+#include <algorithm>
 
 #include <boost/iostreams/stream.hpp>
 
@@ -13,6 +14,7 @@
 #include <extension/TorrentPlugin.hpp>
 #include <extension/Exception.hpp>
 #include <extension/Status.hpp>
+#include <extension/ColumnarStatus.hpp>
 #include <extension/Alert.hpp>
 #include <extension/detail.hpp>
 #include <extension/ExtendedMessage.hpp>
@@ -24,10 +26,70 @@
 #include <libtorrent/socket_io.hpp>
 #include <libtorrent/peer_info.hpp>
 #include <libtorrent/alert_manager.hpp>
+#include <libtorrent/peer_connection.hpp>
 
 namespace joystream {
 namespace extension {
 
+    namespace {
+
+        // Writes payload into buffer, except for one given run of bytes, which is
+        // referenced rather than copied if it is written last and in one go
+        class ReferencingWriteBuffer : public std::streambuf {
+
+        public:
+
+            ReferencingWriteBuffer(char * begin, char * end, const char * reference, std::streamsize referenceLength)
+                : _reference(reference)
+                , _referenceLength(referenceLength)
+                , _referenced(false) {
+                setp(begin, end);
+            }
+
+            // Whether run was referenced, with nothing following it
+            bool referenced() const {
+                return _referenced;
+            }
+
+        protected:
+
+            virtual std::streamsize xsputn(const char * s, std::streamsize n) override {
+
+                // Nothing may follow referenced run
+                if(_referenced)
+                    return 0;
+
+                if(s == _reference && n == _referenceLength) {
+                    _referenced = true;
+                    return n;
+                }
+
+                return std::streambuf::xsputn(s, n);
+            }
+
+        private:
+
+            const char * _reference;
+
+            std::streamsize _referenceLength;
+
+            bool _referenced;
+        };
+
+        // Bytes of full piece message preceeding piece data, which is assumed to end message
+        std::streamsize fullPiecePrefixSize() {
+
+            static const std::streamsize size = protocol_wire::OutputWireStream::sizeOf(protocol_wire::FullPiece());
+
+            return size;
+        }
+
+        // Bytes of piece data in full piece message payload of given size
+        uint64_t pieceDataSize(std::streamsize payloadSize) {
+            return payloadSize > fullPiecePrefixSize() ? payloadSize - fullPiecePrefixSize() : 0;
+        }
+    }
+
     PeerPlugin::PeerPlugin(TorrentPlugin * plugin,
                            const libtorrent::torrent_handle & torrent,
                            const libtorrent::peer_connection_handle & connection,
@@ -43,7 +105,9 @@ namespace extension {
         , _clientMapping(ExtendedMessageIdMapping::consecutiveIdsStartingAt(_minimumMessageId))
         , _sendUninstallMappingOnNextExtendedHandshake(false)
         , _peerBEP10SupportStatus(BEPSupportStatus::unknown)
-        , _peerPaymentBEPSupportStatus(BEPSupportStatus::unknown) {
+        , _peerPaymentBEPSupportStatus(BEPSupportStatus::unknown)
+        , _fullPieceBytesHashed(0)
+        , _fullPieceLength(0) {
 
         // 0 is not a valid minimum message id
         if(_minimumMessageId == 0)
@@ -138,14 +202,14 @@ namespace extension {
         // Check if BEP10 is enabled
         if(reserved_bits[5] & 0x10) {
 
-            std::clog << "BEP10 supported in handshake." << std::endl;
+            JOYSTREAM_EXTENSION_LOG(Debug, "BEP10 supported in handshake.");
 
             // bep10 is supported
             _peerBEP10SupportStatus = BEPSupportStatus::supported;
 
         } else {
 
-            std::clog << "BEP10 not supported in handshake." << std::endl;
+            JOYSTREAM_EXTENSION_LOG(Debug, "BEP10 not supported in handshake.");
 
             // bep10 is not supported
             _peerBEP10SupportStatus = BEPSupportStatus::not_supported;
@@ -170,13 +234,15 @@ namespace extension {
         libtorrent::peer_info peerInfo;
         _connection.get_peer_info(peerInfo);
 
-        std::clog << "on_extension_handshake[" << peerInfo.client.c_str() << "]" << std::endl;
+        JOYSTREAM_EXTENSION_LOG(Debug, "on_extension_handshake[" << peerInfo.client.c_str() << "]");
 
         // Check that BEP10 was actually supported, if it wasnt, then the peer is misbehaving
         if(_peerBEP10SupportStatus != BEPSupportStatus::supported) {
 
+            handshakeProcessed(HandshakeOutcome::Misbehaved);
+
             // Remove peer
-            std::clog << "Dropping Peer: bad handshake (non-BEP10 peer sent extended handshake)" << std::endl;
+            JOYSTREAM_EXTENSION_LOG(Warning, "Dropping Peer: bad handshake (non-BEP10 peer sent extended handshake)");
             libtorrent::error_code ec; // "Peer misbehaved: didn't support BEP10, but it sent extended handshake."
             drop(ec);
 
@@ -191,8 +257,10 @@ namespace extension {
             // Mark peer as not supporting this extension
             _peerPaymentBEPSupportStatus = BEPSupportStatus::not_supported;
 
+            handshakeProcessed(HandshakeOutcome::Malformed);
+
             // Remove peer
-            std::clog << "Dropping Peer: bad handshake (not dictionary)" << std::endl;
+            JOYSTREAM_EXTENSION_LOG(Warning, "Dropping Peer: bad handshake (not dictionary)");
             libtorrent::error_code ec; // "Malformed handshake received: not dictionary."
             drop(ec);
 
@@ -212,11 +280,15 @@ namespace extension {
                 // Peer has previosly signaled support for the extension and sent a full mapping
                 // If the version string is not in the extension, it has not properly sent an unmapping
 
+                handshakeProcessed(HandshakeOutcome::Misbehaved);
+
                 // Remove peer
-                std::clog << "Dropping Peer: bad handshake - peer sent full mapping without first sending unmapping" << std::endl;
+                JOYSTREAM_EXTENSION_LOG(Warning, "Dropping Peer: bad handshake - peer sent full mapping without first sending unmapping");
                 libtorrent::error_code ec; // "Malformed protocol version format provided: " << versionString
                 drop(ec);
-            }
+
+            } else
+                handshakeProcessed(HandshakeOutcome::NotSupported);
 
             // Keep plugin around
             return true;
@@ -232,8 +304,10 @@ namespace extension {
             // Mark peer as not supporting this extension
             _peerPaymentBEPSupportStatus = BEPSupportStatus::not_supported;
 
+            handshakeProcessed(HandshakeOutcome::Malformed);
+
             // Remove peer
-            std::clog << "Dropping Peer: bad handshake (malformed protocol vesrion format)" << std::endl;
+            JOYSTREAM_EXTENSION_LOG(Warning, "Dropping Peer: bad handshake (malformed protocol vesrion format)");
             libtorrent::error_code ec; // "Malformed protocol version format provided: " << versionString
             drop(ec);
 
@@ -246,8 +320,10 @@ namespace extension {
           // Mark peer as not supporting this extension
           _peerPaymentBEPSupportStatus = BEPSupportStatus::not_supported;
 
+          handshakeProcessed(HandshakeOutcome::IncompatibleVersion);
+
           // Remove peer
-          std::clog << "Dropping Peer: (incompatible protocol vesrion)" << std::endl;
+          JOYSTREAM_EXTENSION_LOG(Warning, "Dropping Peer: (incompatible protocol vesrion)");
           libtorrent::error_code ec;
           drop(ec);
 
@@ -263,8 +339,10 @@ namespace extension {
             // Mark peer as not supporting this extension
             _peerPaymentBEPSupportStatus = BEPSupportStatus::not_supported;
 
+            handshakeProcessed(HandshakeOutcome::Malformed);
+
             // Remove peer
-            std::clog << "Dropping Peer: bad handshake (m key not present)" << std::endl;
+            JOYSTREAM_EXTENSION_LOG(Warning, "Dropping Peer: bad handshake (m key not present)");
             libtorrent::error_code ec; // "Malformed handshake received: m key not present."
             drop(ec);
 
@@ -278,8 +356,10 @@ namespace extension {
             // Mark peer as not supporting this extension
             _peerPaymentBEPSupportStatus  = BEPSupportStatus::not_supported;
 
+            handshakeProcessed(HandshakeOutcome::Malformed);
+
             // Remove peer
-            std::clog << "Dropping Peer: bad handshake (m key not mapping to dictionary)" << std::endl;
+            JOYSTREAM_EXTENSION_LOG(Warning, "Dropping Peer: bad handshake (m key not mapping to dictionary)");
             libtorrent::error_code ec; // "Malformed handshake received: m key not mapping to dictionary."
             drop(ec);
 
@@ -289,10 +369,14 @@ namespace extension {
 
         bool peerMappingWasPreviouslySet = !_peerMapping.empty();
 
-        try {
+        boost::optional<exception::InvalidMessageMappingDictionary::Problem> problem;
+
+        ExtendedMessageIdMapping peerMapping = ExtendedMessageIdMapping::fromMDictionary(m, problem);
+
+        if(!problem) {
 
             // Store fully valid (non-uninstall) mapping of peer
-            _peerMapping = ExtendedMessageIdMapping::fromMDictionary(m);
+            _peerMapping = peerMapping;
 
             // Peer should not send a full mapping more than once
             if (peerMappingWasPreviouslySet) {
@@ -301,15 +385,17 @@ namespace extension {
                 // Mark peer as not supporting this extension
                 _peerPaymentBEPSupportStatus  = BEPSupportStatus::not_supported;
 
+                handshakeProcessed(HandshakeOutcome::Misbehaved);
+
                 // Remove peer
-                std::clog << "Dropping Peer: bad handshake (peer already sent full mapping)" << std::endl;
+                JOYSTREAM_EXTENSION_LOG(Warning, "Dropping Peer: bad handshake (peer already sent full mapping)");
                 libtorrent::error_code ec; // "Peer misbehaved: sent uninstall mapping, despite not recently annoncing valid mapping to uninstall."
                 drop(ec);
 
                 return true;
             }
 
-        } catch(const exception::InvalidMessageMappingDictionary & e) {
+        } else {
 
             // Discard old mapping
             _peerMapping.clear();
@@ -318,40 +404,45 @@ namespace extension {
             _peerPaymentBEPSupportStatus  = BEPSupportStatus::not_supported;
 
             // If the uninstall mapping was valid we do not need to disconnect the peer
-            if(e.problem == exception::InvalidMessageMappingDictionary::Problem::UninstallMappingFound) {
+            if(*problem == exception::InvalidMessageMappingDictionary::Problem::UninstallMappingFound) {
                if(peerMappingWasPreviouslySet) {
-                    std::clog << "Removing Peer from Session - Uninstall mapping was sent." << std::endl;
+                    handshakeProcessed(HandshakeOutcome::Uninstalled);
+                    JOYSTREAM_EXTENSION_LOG(Info, "Removing Peer from Session - Uninstall mapping was sent.");
                     // Remove from session if present
                     _plugin->removeFromSession(this);
                } else {
-                    std::clog << "Dropping Peer: bad handshake (attempting to uninstall mapping but no mapping exists)" << std::endl;
+                    handshakeProcessed(HandshakeOutcome::Misbehaved);
+                    JOYSTREAM_EXTENSION_LOG(Warning, "Dropping Peer: bad handshake (attempting to uninstall mapping but no mapping exists)");
                     libtorrent::error_code ec;
                     drop(ec);
                }
-            }
+            } else
+                handshakeProcessed(HandshakeOutcome::Malformed);
 
             // Keep us around
             return true;
         }
 
-        std::clog << "Found extension handshake for peer " << libtorrent::print_endpoint(_endPoint) << std::endl;
+        JOYSTREAM_EXTENSION_LOG(Info, "Found extension handshake for peer " << libtorrent::print_endpoint(_endPoint));
 
         assert(!peerMappingWasPreviouslySet);
 
         // All messages were present, hence the protocol is supported
         _peerPaymentBEPSupportStatus = BEPSupportStatus::supported;
 
+        handshakeProcessed(HandshakeOutcome::Accepted);
+
         // Add peer to session if it is currently not stopped
         if(_plugin->sessionState() != protocol_session::SessionState::stopped) {
 
-            std::clog << "Added peer to non-stopped session" << std::endl;
+            JOYSTREAM_EXTENSION_LOG(Info, "Added peer to non-stopped session");
 
             // NB: in the future, supply _protocolVersionOfPeer to session?
 
             _plugin->addToSession(this);
 
         } else
-            std::clog << "Peer not added to stopped session" << std::endl;
+            JOYSTREAM_EXTENSION_LOG(Info, "Peer not added to stopped session");
 
         // Keep us around
         return true;
@@ -468,21 +559,42 @@ namespace extension {
         }
         */
 
+        // Is it a message for this extension? Messages of other extensions, e.g. ut_metadata
+        // and ut_pex, are common, so they are turned away with a table lookup and nothing more.
+        const boost::optional<MessageType> mappedMessageType = (msg >= 0 && msg <= 255) ? _peerMapping.tryMessageType(static_cast<uint8_t>(msg)) : boost::optional<MessageType>();
+
+        // Messages arrive one after the other, so piece data hashed so far belongs to a
+        // full piece message which ended unseen, if this is another message, or less of one
+        if(_fullPieceBytesHashed > 0 &&
+           (!mappedMessageType || *mappedMessageType != MessageType::full_piece || body.left() < _fullPieceBytesHashed))
+            resetFullPieceHash();
+
+        // Not for us, Let next plugin handle message
+        if(!mappedMessageType)
+            return false;
+
+        const MessageType messageType = *mappedMessageType;
+
         // If this peer is not part of this session, then we ignore the message
         if(_plugin->_session.mode() == protocol_session::SessionMode::not_set) {
-            std::clog << "Warning: Ignoring extended message, session mode not set" << std::endl;
+            JOYSTREAM_EXTENSION_LOG(Warning, "Warning: Ignoring extended message, session mode not set");
+            resetFullPieceHash();
             return false;
         }
 
         if(!_plugin->peerInSession(this)) {
-            std::clog << "Warning: Ignoring extended message, connection not in session" << std::endl;
+            JOYSTREAM_EXTENSION_LOG(Warning, "Warning: Ignoring extended message, connection not in session");
+            resetFullPieceHash();
             return false;
         }
 
         assert(_peerPaymentBEPSupportStatus == BEPSupportStatus::supported);
 
         // Ignore message if peer has not successfully completed BEP43 handshake (yet, or perhaps never will)
-        if(_peerPaymentBEPSupportStatus != BEPSupportStatus::supported) return false;
+        if(_peerPaymentBEPSupportStatus != BEPSupportStatus::supported) {
+            resetFullPieceHash();
+            return false;
+        }
 
         // Length of extended message, excluding the bep 10 id and extended message id.
         int lengthOfMessage = body.left();
@@ -493,24 +605,15 @@ namespace extension {
             // Output progress - too exessive
             // std::clog << "on_extended(id =" << msg << ", length =" << length << "): %" << ((float)(100*lengthOfMessage))/length << std::endl;
 
+            // Hash piece data as it arrives, rather than all of it once the last byte lands
+            if(messageType == MessageType::full_piece)
+                hashFullPieceData(body);
+
             // No other plugin should look at this
             return true;
 
         } else
-            std::clog << "on_extended(id =" << msg << ", length =" << length << ")" << std::endl;
-
-        // Is it a message for this extension?
-        MessageType messageType;
-
-        try {
-            messageType = _peerMapping.messageType(msg);
-        } catch(std::exception & e) {
-
-            std::clog << "Received extended message, but not with registered extended id, not for this plugin then, letting another plugin handle it." << std::endl;
-
-            // Not for us, Let next plugin handle message
-            return false;
-        }
+            JOYSTREAM_EXTENSION_LOG(Debug, "on_extended(id =" << msg << ", length =" << length << ")");
 
         /**
         // Check that plugin is in good state
@@ -523,7 +626,21 @@ namespace extension {
         }
         */
 
-        std::clog << "extended message=" << getMessageName(messageType) << std::endl;
+        JOYSTREAM_EXTENSION_LOG(Debug, "extended message=" << getMessageName(messageType));
+
+        // Times parsing, and then dispatching, of message
+        Stopwatch stopwatch;
+
+        // Finish hash of piece data, for fullPieceArrived to compare with that of torrent
+        if(messageType == MessageType::full_piece) {
+
+            hashFullPieceData(body);
+
+            _fullPieceHash = _fullPieceHasher.final();
+            _fullPieceLength = static_cast<int>(pieceDataSize(lengthOfMessage));
+
+            resetFullPieceHash();
+        }
 
         char* begin = const_cast<char *>(body.begin);
         char_array_buffer buffer(begin, begin + lengthOfMessage);
@@ -533,56 +650,67 @@ namespace extension {
         try {
             switch(messageType) {
                 case MessageType::observe : {
-                    _plugin->processExtendedMessage<>(this, stream.readObserve());
+                    processExtendedMessage(messageType, stream.readObserve(), stopwatch);
                     break;
                 }
                 case MessageType::buy : {
-                    _plugin->processExtendedMessage<>(this, stream.readBuy());
+                    processExtendedMessage(messageType, stream.readBuy(), stopwatch);
                     break;
                 }
                 case MessageType::sell : {
-                    _plugin->processExtendedMessage<>(this, stream.readSell());
+                    processExtendedMessage(messageType, stream.readSell(), stopwatch);
                     break;
                 }
                 case MessageType::join_contract : {
-                    _plugin->processExtendedMessage<>(this, stream.readJoinContract());
+                    processExtendedMessage(messageType, stream.readJoinContract(), stopwatch);
                     break;
                 }
                 case MessageType::joining_contract : {
-                    _plugin->processExtendedMessage<>(this, stream.readJoiningContract());
+                    processExtendedMessage(messageType, stream.readJoiningContract(), stopwatch);
                     break;
                 }
                 case MessageType::ready : {
-                    _plugin->processExtendedMessage<>(this, stream.readReady());
+                    processExtendedMessage(messageType, stream.readReady(), stopwatch);
                     break;
                 }
                 case MessageType::request_full_piece : {
-                    _plugin->processExtendedMessage<>(this, stream.readRequestFullPiece());
+                    processExtendedMessage(messageType, stream.readRequestFullPiece(), stopwatch);
                     break;
                 }
                 case MessageType::full_piece : {
-                    _plugin->processExtendedMessage<>(this, stream.readFullPiece());
+                    processExtendedMessage(messageType, stream.readFullPiece(), stopwatch);
                     break;
                 }
                 case MessageType::payment : {
-                    _plugin->processExtendedMessage<>(this, stream.readPayment());
+                    processExtendedMessage(messageType, stream.readPayment(), stopwatch);
                     break;
                 }
                 case MessageType::speedTestRequest : {
-                    _plugin->processExtendedMessage<>(this, stream.readSpeedTestRequest());
+                    processExtendedMessage(messageType, stream.readSpeedTestRequest(), stopwatch);
                     break;
                 }
                 case MessageType::speedTestPayload : {
-                    _plugin->processExtendedMessage<>(this, stream.readSpeedTestPayload());
+                    processExtendedMessage(messageType, stream.readSpeedTestPayload(), stopwatch);
                     break;
                 }
                 default:
                     assert(false);
             }
 
+            _plugin->metrics().messageReceived(messageType, lengthOfMessage);
+
+            if(messageType == MessageType::full_piece)
+                transferred(TransferEvent::PieceReceived, pieceDataSize(lengthOfMessage));
+
+            _flightRecorder.record(FlightRecord::Kind::MessageReceived, static_cast<uint8_t>(messageType), lengthOfMessage);
+
         } catch (std::exception & e) {
 
-            std::clog << "Dropping Peer: Extended Message was Malformed:" << e.what() << std::endl;
+            JOYSTREAM_EXTENSION_LOG(Warning, "Dropping Peer: Extended Message was Malformed:" << e.what());
+
+            _plugin->metrics().malformedMessage();
+
+            _flightRecorder.record(FlightRecord::Kind::MalformedMessage, static_cast<uint8_t>(messageType), lengthOfMessage);
 
             // Remove this peer
             libtorrent::error_code ec; // <-- "Malformed extended message received, removing."
@@ -590,6 +718,9 @@ namespace extension {
             drop(ec);
         }
 
+        // Only valid while message is processed
+        _fullPieceHash = boost::none;
+
         // No other plugin should process message
         return true;
     }
@@ -630,11 +761,34 @@ namespace extension {
     }
 
     status::PeerPlugin PeerPlugin::status(const boost::optional<protocol_session::status::Connection<libtorrent::peer_id>> & connection) const {
-        return status::PeerPlugin(_connection.pid(),
+
+        status::PeerPlugin status(_connection.pid(),
                                   _endPoint,
                                   _peerBEP10SupportStatus,
                                   _peerPaymentBEPSupportStatus,
                                   connection);
+
+        status.transfer = _transfer.status(std::chrono::steady_clock::now());
+
+        return status;
+    }
+
+    void PeerPlugin::exportStatus(status::ColumnarStatus & columns, bool inSession, const std::chrono::steady_clock::time_point & now) const {
+
+        columns.peerId.push_back(_connection.pid());
+        columns.peerEndPoint.push_back(_endPoint);
+        columns.peerBEP10SupportStatus.push_back(static_cast<uint8_t>(_peerBEP10SupportStatus));
+        columns.peerPaymentBEPSupportStatus.push_back(static_cast<uint8_t>(_peerPaymentBEPSupportStatus));
+        columns.peerInSession.push_back(inSession);
+        columns.peerTransfer.append(_transfer.status(now));
+    }
+
+    void PeerPlugin::transferred(TransferEvent event, uint64_t amount) {
+
+        const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+        _transfer.record(event, amount, now);
+        _plugin->transferred(event, amount, now);
     }
 
     libtorrent::peer_connection_handle PeerPlugin::connection() const {
@@ -673,6 +827,13 @@ namespace extension {
 
       _undead = true;
 
+      // Leave trace of what lead up to drop, unless it was routine, e.g. a banned
+      // endpoint or a peer without extension, so churn does not flood alert queue
+      _flightRecorder.record(FlightRecord::Kind::Dropped);
+
+      if(_flightRecorder.noteworthy())
+          _alertManager->emplace_alert<alert::ConnectionFlightRecord>(_torrent, _endPoint, _connection.pid(), ec, _flightRecorder.recorded(), _flightRecorder.records());
+
       _connection.disconnect(ec, libtorrent::operation_t::op_bittorrent);
     }
 
@@ -684,6 +845,138 @@ namespace extension {
       return _peerPaymentBEPSupportStatus;
     }
 
+    void PeerPlugin::messageSent(MessageType messageType, std::size_t bytes, Stopwatch & stopwatch) {
+
+        _plugin->metrics().messageSent(messageType, bytes);
+
+        if(messageType == MessageType::full_piece)
+            transferred(TransferEvent::PieceSent, pieceDataSize(bytes));
+
+        // Session only sends messages when state of connection changes, including when
+        // it does so on its own in tick, e.g. requesting next piece or paying for one
+        _plugin->markStatusChanged();
+
+        _flightRecorder.record(FlightRecord::Kind::MessageSent, static_cast<uint8_t>(messageType), bytes);
+
+        if(Stopwatch::enabled)
+            stopwatch.lap(_plugin->messageLatency(messageType).send);
+    }
+
+    template<class M>
+    void PeerPlugin::processExtendedMessage(MessageType messageType, const M & message, Stopwatch & stopwatch) {
+
+        if(Stopwatch::enabled)
+            stopwatch.lap(_plugin->messageLatency(messageType).parse);
+
+        _plugin->processExtendedMessage<>(this, message);
+
+        if(Stopwatch::enabled)
+            stopwatch.lap(_plugin->messageLatency(messageType).dispatch);
+    }
+
+    void PeerPlugin::handshakeProcessed(HandshakeOutcome outcome) {
+
+        _plugin->metrics().handshake(outcome);
+
+        _flightRecorder.record(FlightRecord::Kind::Handshake, static_cast<uint8_t>(outcome));
+
+        if(outcome == HandshakeOutcome::Malformed || outcome == HandshakeOutcome::Misbehaved)
+            _flightRecorder.markNoteworthy();
+    }
+
+    bool PeerPlugin::sendByReference(const protocol_wire::FullPiece & payload, Stopwatch & stopwatch) {
+
+        const protocol_wire::PieceData pieceData = payload.pieceData();
+        const std::streamsize size = protocol_wire::OutputWireStream::sizeOf(payload);
+
+        if(!pieceData.piece() || pieceData.length() <= 0 || size < pieceData.length())
+            return false;
+
+        // Piece data is assumed to end payload
+        const std::streamsize bufferedSize = size - pieceData.length();
+
+        const MessageType messageType = getMessageType(payload);
+
+        ExtendedMessage m(size, bufferedSize, _peerMapping.id(messageType), sendBufferPool());
+
+        ReferencingWriteBuffer buffer(m.payload(), m.payload() + bufferedSize, pieceData.piece().get(), pieceData.length());
+        protocol_wire::OutputWireStream writer(&buffer);
+
+        std::streamsize written = 0;
+
+        try {
+            written = writer.write(payload);
+        } catch(std::exception &) {
+            return false;
+        }
+
+        // Piece data was not written as one trailing run, e.g. copied by
+        // serialization, so fall back to copying path
+        if(written != size || !buffer.referenced())
+            return false;
+
+        boost::shared_ptr<libtorrent::peer_connection> connection = _connection.native_handle();
+
+        if(!connection)
+            return false;
+
+        // Header and whatever preceeds piece data
+        m.send(_connection);
+
+        // Connection holds reference to piece data until it has been written to socket
+        connection->append_const_send_buffer(pieceData.piece().get(),
+                                             pieceData.length(),
+                                             &PeerPlugin::releasePieceData,
+                                             new boost::shared_array<char>(pieceData.piece()));
+        connection->setup_send();
+
+        messageSent(messageType, written, stopwatch);
+
+        JOYSTREAM_EXTENSION_LOG(Debug, "SENT: " << getMessageName(messageType) << " (" << written << ") bytes, by reference");
+
+        return true;
+    }
+
+    void PeerPlugin::releasePieceData(char *, void * userdata, libtorrent::block_cache_reference) {
+        delete static_cast<boost::shared_array<char> *>(userdata);
+    }
+
+    SendBufferPool & PeerPlugin::sendBufferPool() {
+        return _plugin->sendBufferPool();
+    }
+
+    FlightRecorder & PeerPlugin::flightRecorder() {
+        return _flightRecorder;
+    }
+
+    libtorrent::sha1_hash PeerPlugin::pieceDataHash(const protocol_wire::PieceData & pieceData) const {
+
+        if(_fullPieceHash && _fullPieceLength == pieceData.length())
+            return *_fullPieceHash;
+
+        return libtorrent::hasher(pieceData.piece().get(), pieceData.length()).final();
+    }
+
+    void PeerPlugin::hashFullPieceData(libtorrent::buffer::const_interval body) {
+
+        // Skip what was already hashed, and whatever preceeds piece data
+        const int begin = std::max(_fullPieceBytesHashed, static_cast<int>(fullPiecePrefixSize()));
+
+        if(body.left() > begin)
+            _fullPieceHasher.update(body.begin + begin, body.left() - begin);
+
+        _fullPieceBytesHashed = std::max(_fullPieceBytesHashed, body.left());
+    }
+
+    void PeerPlugin::resetFullPieceHash() {
+
+        if(_fullPieceBytesHashed == 0)
+            return;
+
+        _fullPieceHasher.reset();
+        _fullPieceBytesHashed = 0;
+    }
+
     /**
     bool PeerPlugin::peerTimedOut(int maxDelay) const {
         return (!_timeSinceLastMessageSent.isNull()) && (_timeSinceLastMessageSent.elapsed() > maxDelay);
@@ -14,22 +14,45 @@
 
 #include <boost/shared_ptr.hpp>
 
+
 namespace joystream {
 namespace extension {
 
+constexpr uint64_t Plugin::noTorrentPluginStatusUpdatePending;
+
 Plugin::Plugin(uint minimumMessageId,
                Coin::Network network,
                libtorrent::alert_manager * alertManager,
-               libtorrent::aux::session_impl * session)
+               libtorrent::aux::session_impl * session,
+               const Policy & policy)
     : _alertManager(alertManager)
     , _session(session)
     , _minimumMessageId(minimumMessageId)
     , _network(network)
-    , _addedToSession(false) {
+    , _addedToSession(false)
+    , _policy(policy)
+    , _controlRequestQueue(policy.requestQueueCapacity)
+    , _bulkRequestQueue(policy.requestQueueCapacity)
+    , _rejectedRequests(0)
+    , _coalescedRequests(0)
+    , _requestProcessingBudgetExhausted(0)
+    , _torrentPluginStatusUpdatePending(noTorrentPluginStatusUpdatePending)
+    , _torrentPluginStatusUpdateOrphaned(false)
+    , _requestProcessingScheduled(false)
+    , _sendBufferPool(policy.sendBufferPoolCapacity)
+    , _torrentPluginStatusUpdatesDeferred(noTorrentPluginStatusUpdatePending)
+    , _torrentRequestsQueued(0)
+    , _statusGeneration(0) {
+
+    for(std::size_t i = 0;i < numberOfMessageTypes;i++)
+        _messageLatencies[i].messageType = getMessageName(static_cast<MessageType>(i));
+
+    for(std::shared_ptr<const PublishedStatusMap> & shard : _publishedStatuses)
+        shard = std::make_shared<PublishedStatusMap>();
 }
 
 Plugin::~Plugin() {
-    std::clog << "~Plugin." << std::endl;
+    JOYSTREAM_EXTENSION_LOG(Info, "~Plugin.");
 }
 
 boost::uint32_t Plugin::implemented_features() {
@@ -45,7 +68,7 @@ boost::shared_ptr<libtorrent::torrent_plugin> Plugin::new_torrent(libtorrent::to
                                                          h,
                                                          _minimumMessageId,
                                                          _alertManager,
-                                                         TorrentPlugin::Policy(),
+                                                         _policy.torrentPluginPolicy,
                                                          TorrentPlugin::LibtorrentInteraction::None);
 
     boost::shared_ptr<libtorrent::torrent_plugin> plugin(rawTorrentPlugin);
@@ -53,16 +76,24 @@ boost::shared_ptr<libtorrent::torrent_plugin> Plugin::new_torrent(libtorrent::to
     // Storing weak reference to plugin
     _torrentPlugins[h.info_hash()] = boost::static_pointer_cast<TorrentPlugin>(plugin);
 
+    // Make status readable from other threads
+    rawTorrentPlugin->publishStatus();
+    updatePublishedStatuses(h.info_hash(), rawTorrentPlugin->publishedStatus());
+
     return plugin;
 }
 
 void Plugin::added(libtorrent::session_handle h) {
 
-    std::clog << "Plugin added to session." << std::endl;
+    JOYSTREAM_EXTENSION_LOG(Info, "Plugin added to session.");
 
     _session = h.native_handle();
     _alertManager = &h.native_handle()->alerts();
     _addedToSession = true;
+
+    // Process whatever was submitted before we were added
+    if(_policy.wakeNetworkThreadOnSubmit && requestQueueDepth() > 0)
+        scheduleRequestProcessing();
 }
 
 void Plugin::on_alert(libtorrent::alert const * a) {
@@ -84,9 +115,13 @@ void Plugin::on_alert(libtorrent::alert const * a) {
         plugin->pieceRead(p);
     }
 
+    if(_policy.postMetricsWithSessionStats && libtorrent::alert_cast<libtorrent::session_stats_alert>(a))
+        _alertManager->emplace_alert<alert::MetricsAlert>(_metrics.snapshot());
+
     if(libtorrent::torrent_removed_alert const * p = libtorrent::alert_cast<libtorrent::torrent_removed_alert>(a)) {
         const libtorrent::sha1_hash infoHash = p->handle.info_hash();
         _torrentPlugins.erase(infoHash);
+        updatePublishedStatuses(infoHash, nullptr);
     }
 }
 
@@ -106,38 +141,385 @@ void Plugin::save_state(libtorrent::entry &) const {
 void Plugin::load_state(const libtorrent::bdecode_node &) {
 }
 
-const std::map<libtorrent::sha1_hash, boost::weak_ptr<TorrentPlugin> > & Plugin::torrentPlugins() const noexcept {
+const Plugin::TorrentPluginMap & Plugin::torrentPlugins() const noexcept {
     return _torrentPlugins;
 }
 
+std::shared_ptr<const status::TorrentPluginSnapshot> Plugin::readStatus(const libtorrent::sha1_hash & infoHash) const {
+
+    std::shared_ptr<const PublishedStatusMap> publishedStatuses = std::atomic_load(&publishedStatusShard(infoHash));
+
+    auto it = publishedStatuses->find(infoHash);
+
+    if(it == publishedStatuses->cend())
+        return nullptr;
+
+    return std::atomic_load(&it->second->snapshot);
+}
+
+std::vector<std::shared_ptr<const status::TorrentPluginSnapshot> > Plugin::readStatuses() const {
+
+    std::vector<std::shared_ptr<const status::TorrentPluginSnapshot> > snapshots;
+
+    for(const std::shared_ptr<const PublishedStatusMap> & shard : _publishedStatuses) {
+
+        std::shared_ptr<const PublishedStatusMap> publishedStatuses = std::atomic_load(&shard);
+
+        for(const auto & m : *publishedStatuses)
+            if(std::shared_ptr<const status::TorrentPluginSnapshot> snapshot = std::atomic_load(&m.second->snapshot))
+                snapshots.push_back(std::move(snapshot));
+    }
+
+    return snapshots;
+}
+
+std::shared_ptr<const Plugin::PublishedStatusMap> & Plugin::publishedStatusShard(const libtorrent::sha1_hash & infoHash) {
+    return _publishedStatuses[std::hash<libtorrent::sha1_hash>()(infoHash) % numberOfPublishedStatusShards];
+}
+
+const std::shared_ptr<const Plugin::PublishedStatusMap> & Plugin::publishedStatusShard(const libtorrent::sha1_hash & infoHash) const {
+    return _publishedStatuses[std::hash<libtorrent::sha1_hash>()(infoHash) % numberOfPublishedStatusShards];
+}
+
+void Plugin::updatePublishedStatuses(const libtorrent::sha1_hash & infoHash, const std::shared_ptr<TorrentPlugin::PublishedStatus> & publishedStatus) {
+
+    std::shared_ptr<const PublishedStatusMap> & shard = publishedStatusShard(infoHash);
+
+    // Only network thread writes, so copy of current shard is up to date.
+    // Readers holding previous shard keep it alive until they are done.
+    std::shared_ptr<PublishedStatusMap> publishedStatuses = std::make_shared<PublishedStatusMap>(*shard);
+
+    if(publishedStatus)
+        (*publishedStatuses)[infoHash] = publishedStatus;
+    else
+        publishedStatuses->erase(infoHash);
+
+    std::atomic_store(&shard, std::shared_ptr<const PublishedStatusMap>(std::move(publishedStatuses)));
+}
+
 Coin::Network Plugin::network() const {
   return _network;
 }
 
+status::Metrics Plugin::metrics() const {
+    return _metrics.snapshot();
+}
+
+status::SendBufferPool Plugin::sendBufferPoolStatistics() const {
+    return _sendBufferPool.statistics();
+}
+
+bool Plugin::submitBatch(std::vector<detail::RequestVariant> requests, const request::BatchHandler & handler) {
+    return submit(detail::RequestBatch(std::move(requests), handler));
+}
+
+std::size_t Plugin::requestQueueDepth() const noexcept {
+    return _controlRequestQueue.size() + _bulkRequestQueue.size();
+}
+
+std::size_t Plugin::requestQueueDepth(request::Priority priority) const noexcept {
+    return requestQueue(priority).size();
+}
+
+detail::RequestQueue<detail::QueuedRequest> & Plugin::requestQueue(request::Priority priority) {
+    return priority == request::Priority::Control ? _controlRequestQueue : _bulkRequestQueue;
+}
+
+const detail::RequestQueue<detail::QueuedRequest> & Plugin::requestQueue(request::Priority priority) const {
+    return priority == request::Priority::Control ? _controlRequestQueue : _bulkRequestQueue;
+}
+
+uint64_t Plugin::rejectedRequests() const noexcept {
+    return _rejectedRequests.load(std::memory_order_relaxed);
+}
+
+uint64_t Plugin::coalescedRequests() const noexcept {
+    return _coalescedRequests.load(std::memory_order_relaxed);
+}
+
+uint64_t Plugin::requestProcessingBudgetExhausted() const noexcept {
+    return _requestProcessingBudgetExhausted.load(std::memory_order_relaxed);
+}
+
+bool Plugin::coalesce(const request::PostTorrentPluginStatusUpdates & r) {
+
+    // Only one snapshot needs to be pending at any given time,
+    // covering changes since the lowest generation asked for
+    uint64_t pending = _torrentPluginStatusUpdatePending.load();
+
+    for(;;) {
+
+        if(pending == noTorrentPluginStatusUpdatePending) {
+
+            if(_torrentPluginStatusUpdatePending.compare_exchange_weak(pending, r.sinceGeneration))
+                return false;
+
+        } else if(pending <= r.sinceGeneration)
+            return true;
+        else if(_torrentPluginStatusUpdatePending.compare_exchange_weak(pending, r.sinceGeneration))
+            return true;
+    }
+}
+
+void Plugin::uncoalesce(const request::PostTorrentPluginStatusUpdates &) {
+
+    // Other threads may already have coalesced their requests into pending
+    // marker, and been told they were queued, so marker is left as is
+    _torrentPluginStatusUpdateOrphaned.store(true);
+
+    if(_policy.wakeNetworkThreadOnSubmit)
+        scheduleRequestProcessing();
+}
+
+uint64_t Plugin::nextStatusGeneration() noexcept {
+    return ++_statusGeneration;
+}
+
+void Plugin::scheduleRequestProcessing() {
+
+    // Session pointer is not safe to use before this
+    if(!_addedToSession)
+        return;
+
+    // Only one pending job at a time
+    if(_requestProcessingScheduled.exchange(true))
+        return;
+
+    // Plugin is owned by session, and outlives any job run by its network thread
+    _session->get_io_service().post([this]() {
+
+        // Cleared before processing, so requests submitted during
+        // processing schedule a new job rather than getting stuck
+        _requestProcessingScheduled.store(false);
+
+        processesRequestQueue();
+    });
+}
+
+status::RequestLatency & Plugin::requestLatency(const detail::RequestVariant & v) {
+
+    status::RequestLatency & latency = _requestLatencies[v.which()];
+
+    // Name on first use
+    if(latency.requestType.empty())
+        latency.requestType = detail::requestTypeName(v);
+
+    return latency;
+}
+
 void Plugin::processesRequestQueue() {
 
     detail::RequestVariantVisitor visitor(this, _session, _alertManager);
 
-    // Synchronized dispatching of requests
-    _requestQueueMutex.lock();
+    detail::QueuedRequest q;
+
+    // Pass is bounded, as it runs on network thread, and holds up peer I/O
+    const std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + _policy.requestProcessingTimeBudget;
+
+    std::size_t requestsProcessed = 0;
+    std::size_t bulkRequestsProcessed = 0;
+
+    bool budgetExhausted = false;
+
+    // Only consumer of queues, so no synchronization beyond queues themselves.
+    // Request is moved out of queue, not copied.
+    for(;;) {
+
+        if((_policy.maxRequestsPerPass > 0 && requestsProcessed >= _policy.maxRequestsPerPass) ||
+           (_policy.requestProcessingTimeBudget.count() > 0 && requestsProcessed > 0 && std::chrono::steady_clock::now() >= deadline)) {
+            budgetExhausted = true;
+            break;
+        }
+
+        // Control requests always go first, including those submitted while processing
+        // bulk requests. Torrent scoped ones are only routed to queue of their torrent
+        // here, and then processed with one request per torrent in turn.
+        // Other control requests wait for torrent scoped ones submitted before them.
+        // Lastly, a single bulk request, unless share of this pass is used up.
+        // Routing a request counts against budget of pass like processing one.
+        if(_heldControlRequest) {
+
+            if(!processNextTorrentRequest(visitor)) {
+
+                q = std::move(*_heldControlRequest);
+                _heldControlRequest = boost::none;
+
+                dispatchQueuedRequest(visitor, q);
+            }
+
+        } else if(_torrentRequestsQueued < _policy.requestQueueCapacity && _controlRequestQueue.tryPop(q)) {
+
+            if(!routeToTorrentRequestQueue(q)) {
+
+                if(_torrentRequestRotation.empty())
+                    dispatchQueuedRequest(visitor, q);
+                else
+                    _heldControlRequest = std::move(q);
+            }
+
+        } else if(!processNextTorrentRequest(visitor)) {
+
+            if(bulkRequestsProcessed < _policy.maxBulkRequestsPerPass && _bulkRequestQueue.tryPop(q)) {
+                dispatchQueuedRequest(visitor, q);
+                bulkRequestsProcessed++;
+            } else
+                break;
+        }
+
+        requestsProcessed++;
+    }
+
+    processDeferredStatusUpdates(visitor);
+
+    const bool requestsRemaining = requestQueueDepth() > 0 || !_torrentRequestRotation.empty() || _heldControlRequest;
+
+    if(budgetExhausted && requestsRemaining)
+        _requestProcessingBudgetExhausted.fetch_add(1, std::memory_order_relaxed);
+
+    // Leave remaining requests for a new job, so network
+    // thread gets to do other work in the mean time
+    if(_policy.wakeNetworkThreadOnSubmit && requestsRemaining)
+        scheduleRequestProcessing();
+}
+
+bool Plugin::routeToTorrentRequestQueue(detail::QueuedRequest & q) {
+
+    const libtorrent::sha1_hash * infoHash = detail::requestTorrent(q.request);
+
+    if(infoHash == nullptr)
+        return false;
+
+    std::deque<detail::QueuedRequest> & queue = _torrentRequestQueues[*infoHash];
+
+    // Torrent joins rotation when it gets its first pending request
+    if(queue.empty())
+        _torrentRequestRotation.push_back(*infoHash);
+
+    queue.push_back(std::move(q));
+    _torrentRequestsQueued++;
+
+    return true;
+}
+
+bool Plugin::processNextTorrentRequest(detail::RequestVariantVisitor & visitor) {
+
+    if(_torrentRequestRotation.empty())
+        return false;
 
-    while(!_requestQueue.empty()) {
+    const libtorrent::sha1_hash infoHash = _torrentRequestRotation.front();
+    _torrentRequestRotation.pop_front();
 
-        detail::RequestVariant v = _requestQueue.front();
-        _requestQueue.pop_front();
+    auto it = _torrentRequestQueues.find(infoHash);
+    assert(it != _torrentRequestQueues.end() && !it->second.empty());
 
-        // Unlock queue mutex for actual processing of request
-        _requestQueueMutex.unlock();
+    detail::QueuedRequest q(std::move(it->second.front()));
+    it->second.pop_front();
+    _torrentRequestsQueued--;
 
-        // Process by applying visitor
-        //boost::apply_visitor(visitor, v);
-        v.apply_visitor(visitor);
+    // Back of the line if torrent has more requests, before processing,
+    // as processing may route new requests
+    if(it->second.empty())
+        _torrentRequestQueues.erase(it);
+    else
+        _torrentRequestRotation.push_back(infoHash);
 
-        // Relock for checking loop condition
-        _requestQueueMutex.lock();
+    dispatchQueuedRequest(visitor, q);
+
+    return true;
+}
+
+void Plugin::dispatchQueuedRequest(detail::RequestVariantVisitor & visitor, detail::QueuedRequest & q) {
+
+    const std::chrono::steady_clock::time_point dequeued = std::chrono::steady_clock::now();
+
+    requestLatency(q.request).queueWait.record(dequeued - q.submitted);
+
+    if(const request::PostTorrentPluginStatusUpdates * r = boost::get<request::PostTorrentPluginStatusUpdates>(&q.request)) {
+
+        // Let ::submit() queue a new one from now on, and pick up
+        // generation of any request coalesced with this one
+        uint64_t sinceGeneration = _torrentPluginStatusUpdatePending.exchange(noTorrentPluginStatusUpdatePending);
+
+        if(sinceGeneration == noTorrentPluginStatusUpdatePending || r->sinceGeneration < sinceGeneration)
+            sinceGeneration = r->sinceGeneration;
+
+        if(_torrentPluginStatusUpdatesDeferred != noTorrentPluginStatusUpdatePending)
+            _coalescedRequests.fetch_add(1, std::memory_order_relaxed);
+
+        if(sinceGeneration < _torrentPluginStatusUpdatesDeferred)
+            _torrentPluginStatusUpdatesDeferred = sinceGeneration;
+
+        if(!_torrentPluginStatusUpdatesDeferredExecutor)
+            _torrentPluginStatusUpdatesDeferredExecutor = q.executor;
+
+    } else if(const request::PostPeerPluginStatusUpdates * r = boost::get<request::PostPeerPluginStatusUpdates>(&q.request)) {
+
+        // Only unfiltered requests are alike, others are processed as is
+        if(!r->query.unfiltered())
+            processRequest(visitor, q.request, dequeued, q.executor);
+        else {
+
+            auto inserted = _peerPluginStatusUpdatesDeferred.insert(std::make_pair(r->_infoHash, q.executor));
+
+            if(!inserted.second) {
+
+                _coalescedRequests.fetch_add(1, std::memory_order_relaxed);
+
+                if(!inserted.first->second)
+                    inserted.first->second = q.executor;
+            }
+        }
+
+    } else
+        processRequest(visitor, q.request, dequeued, q.executor);
+}
+
+void Plugin::processDeferredStatusUpdates(detail::RequestVariantVisitor & visitor) {
+
+    // Take over pending status update of request which could not be queued,
+    // as if it had been taken off queue
+    if(_torrentPluginStatusUpdateOrphaned.exchange(false)) {
+
+        const uint64_t sinceGeneration = _torrentPluginStatusUpdatePending.exchange(noTorrentPluginStatusUpdatePending);
+
+        if(sinceGeneration < _torrentPluginStatusUpdatesDeferred)
+            _torrentPluginStatusUpdatesDeferred = sinceGeneration;
+    }
+
+    // Snapshots reflect state after all other requests in this pass
+    if(_torrentPluginStatusUpdatesDeferred != noTorrentPluginStatusUpdatePending) {
+
+        detail::RequestVariant v = request::PostTorrentPluginStatusUpdates(_torrentPluginStatusUpdatesDeferred);
+        const request::Executor executor = std::move(_torrentPluginStatusUpdatesDeferredExecutor);
+
+        _torrentPluginStatusUpdatesDeferred = noTorrentPluginStatusUpdatePending;
+        _torrentPluginStatusUpdatesDeferredExecutor = request::Executor();
+
+        processRequest(visitor, v, std::chrono::steady_clock::now(), executor);
+    }
+
+    for(const auto & m : _peerPluginStatusUpdatesDeferred) {
+        detail::RequestVariant v = request::PostPeerPluginStatusUpdates(m.first);
+        processRequest(visitor, v, std::chrono::steady_clock::now(), m.second);
     }
 
-    _requestQueueMutex.unlock();
+    _peerPluginStatusUpdatesDeferred.clear();
+}
+
+void Plugin::processRequest(detail::RequestVariantVisitor & visitor,
+                            detail::RequestVariant & v,
+                            const std::chrono::steady_clock::time_point & dequeued,
+                            const request::Executor & executor) {
+
+    visitor.setExecutor(&executor);
+
+    // Process by applying visitor, which may move from request
+    //boost::apply_visitor(visitor, v);
+    v.apply_visitor(visitor);
+
+    visitor.setExecutor(nullptr);
+
+    requestLatency(v).execution.record(std::chrono::steady_clock::now() - dequeued);
 }
 
 }
@@ -0,0 +1,175 @@
+/**
+ * Copyright (C) JoyStream - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#include <extension/SendBufferPool.hpp>
+
+#include <cassert>
+
+namespace joystream {
+namespace extension {
+
+SendBufferPool::Buffer::Buffer()
+    : _pool(nullptr)
+    , _data(nullptr)
+    , _size(0)
+    , _capacity(0)
+    , _sizeClass(0) {
+}
+
+SendBufferPool::Buffer::Buffer(SendBufferPool * pool, char * data, std::size_t size, std::size_t capacity, std::size_t sizeClass)
+    : _pool(pool)
+    , _data(data)
+    , _size(size)
+    , _capacity(capacity)
+    , _sizeClass(sizeClass) {
+}
+
+SendBufferPool::Buffer::~Buffer() {
+    release();
+}
+
+SendBufferPool::Buffer::Buffer(Buffer && o)
+    : _pool(o._pool)
+    , _data(o._data)
+    , _size(o._size)
+    , _capacity(o._capacity)
+    , _sizeClass(o._sizeClass) {
+
+    o._pool = nullptr;
+    o._data = nullptr;
+}
+
+SendBufferPool::Buffer & SendBufferPool::Buffer::operator=(Buffer && o) {
+
+    if(this != &o) {
+
+        release();
+
+        _pool = o._pool;
+        _data = o._data;
+        _size = o._size;
+        _capacity = o._capacity;
+        _sizeClass = o._sizeClass;
+
+        o._pool = nullptr;
+        o._data = nullptr;
+    }
+
+    return *this;
+}
+
+void SendBufferPool::Buffer::release() {
+
+    if(_data != nullptr)
+        _pool->release(_data, _size, _capacity, _sizeClass);
+
+    _pool = nullptr;
+    _data = nullptr;
+}
+
+SendBufferPool::SendBufferPool(std::size_t maxPooledBytes)
+    : _maxPooledBytes(maxPooledBytes)
+    , _hits(0)
+    , _misses(0)
+    , _buffersInUse(0)
+    , _peakBuffersInUse(0)
+    , _bytesInUse(0)
+    , _peakBytesInUse(0)
+    , _requestedBytesInUse(0)
+    , _peakRequestedBytesInUse(0)
+    , _bytesPooled(0) {
+}
+
+SendBufferPool::~SendBufferPool() {
+
+    // Buffers must not outlive pool
+    assert(_buffersInUse.load() == 0);
+
+    for(std::vector<char *> & buffers : _free)
+        for(char * buffer : buffers)
+            delete[] buffer;
+}
+
+SendBufferPool::Buffer SendBufferPool::acquire(std::size_t size) {
+
+    const std::size_t c = sizeClass(size);
+    const std::size_t capacity = (c < numberOfSizeClasses) ? (smallestBufferSize << c) + messageOverhead : size;
+
+    char * data;
+
+    if(c < numberOfSizeClasses && !_free[c].empty()) {
+
+        data = _free[c].back();
+        _free[c].pop_back();
+
+        add(_hits, 1);
+        subtract(_bytesPooled, capacity);
+
+    } else {
+
+        data = new char[capacity];
+
+        add(_misses, 1);
+    }
+
+    add(_buffersInUse, 1);
+    add(_bytesInUse, capacity);
+    add(_requestedBytesInUse, size);
+
+    raise(_peakBuffersInUse, _buffersInUse.load(std::memory_order_relaxed));
+    raise(_peakBytesInUse, _bytesInUse.load(std::memory_order_relaxed));
+    raise(_peakRequestedBytesInUse, _requestedBytesInUse.load(std::memory_order_relaxed));
+
+    return Buffer(this, data, size, capacity, c);
+}
+
+void SendBufferPool::release(char * data, std::size_t size, std::size_t capacity, std::size_t sizeClass) {
+
+    subtract(_buffersInUse, 1);
+    subtract(_bytesInUse, capacity);
+    subtract(_requestedBytesInUse, size);
+
+    // Keep for reuse if it has a class, and pool has room
+    if(sizeClass < numberOfSizeClasses && _bytesPooled.load(std::memory_order_relaxed) + capacity <= _maxPooledBytes) {
+
+        _free[sizeClass].push_back(data);
+
+        add(_bytesPooled, capacity);
+
+    } else
+        delete[] data;
+}
+
+status::SendBufferPool SendBufferPool::statistics() const {
+
+    status::SendBufferPool s;
+
+    s.hits = _hits.load(std::memory_order_relaxed);
+    s.misses = _misses.load(std::memory_order_relaxed);
+    s.buffersInUse = _buffersInUse.load(std::memory_order_relaxed);
+    s.peakBuffersInUse = _peakBuffersInUse.load(std::memory_order_relaxed);
+    s.bytesInUse = _bytesInUse.load(std::memory_order_relaxed);
+    s.peakBytesInUse = _peakBytesInUse.load(std::memory_order_relaxed);
+    s.requestedBytesInUse = _requestedBytesInUse.load(std::memory_order_relaxed);
+    s.peakRequestedBytesInUse = _peakRequestedBytesInUse.load(std::memory_order_relaxed);
+    s.bytesPooled = _bytesPooled.load(std::memory_order_relaxed);
+
+    return s;
+}
+
+std::size_t SendBufferPool::sizeClass(std::size_t size) {
+
+    std::size_t c = 0;
+
+    for(std::size_t capacity = smallestBufferSize;capacity + messageOverhead < size;capacity <<= 1)
+        if(++c == numberOfSizeClasses)
+            break;
+
+    return c;
+}
+
+}
+}
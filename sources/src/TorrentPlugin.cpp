@@ -10,6 +10,7 @@
 #include <extension/Request.hpp>
 #include <extension/Exception.hpp>
 #include <extension/Common.hpp>
+#include <extension/ColumnarStatus.hpp>
 #include <libtorrent/alert_manager.hpp>
 #include <libtorrent/error_code.hpp>
 #include <libtorrent/peer_connection_handle.hpp>
@@ -51,11 +52,18 @@ TorrentPlugin::TorrentPlugin(Plugin * plugin,
     , _policy(policy)
     , _libtorrentInteraction(libtorrentInteraction)
     , _infoHash(torrent.info_hash())
-    , _session(plugin->network()) {
+    , _session(plugin->network())
+    , _statusGeneration(plugin->nextStatusGeneration())
+    , _publishedStatus(std::make_shared<PublishedStatus>())
+    , _publishedStatusGeneration(0)
+    , _nextAggregatedEventsAlert(std::chrono::steady_clock::now() + policy.alertAggregationInterval) {
 }
 
 TorrentPlugin::~TorrentPlugin() {
     //std::clog << "~TorrentPlugin()" << std::endl;
+
+    // Torrent is being removed, or session torn down, do not lose events of last interval
+    postAggregatedEvents();
 }
 
 boost::shared_ptr<libtorrent::peer_plugin> TorrentPlugin::new_connection(const libtorrent::peer_connection_handle & connection) {
@@ -69,15 +77,14 @@ boost::shared_ptr<libtorrent::peer_plugin> TorrentPlugin::new_connection(const l
     // Get end point
     libtorrent::tcp::endpoint endPoint = connection.remote();
 
-    std::clog << "New "
-              << (connection.is_outgoing() ? "outgoing " : "incoming ")
-              << "connection with "
-              << libtorrent::print_endpoint(endPoint)
-              << std::endl; // << "on " << _torrent->name().c_str();
+    JOYSTREAM_EXTENSION_LOG(Debug, "New "
+                            << (connection.is_outgoing() ? "outgoing " : "incoming ")
+                            << "connection with "
+                            << libtorrent::print_endpoint(endPoint)); // << "on " << _torrent->name().c_str();
 
     // We are not interested in managing non bittorrent connections
     if(connection.type() != libtorrent::peer_connection::bittorrent_connection) {
-        std::clog << "Peer was not BitTorrent client, likely web seed." << std::endl;
+        JOYSTREAM_EXTENSION_LOG(Debug, "Peer was not BitTorrent client, likely web seed.");
         return boost::shared_ptr<libtorrent::peer_plugin>(nullptr);
     }
 
@@ -97,11 +104,13 @@ boost::shared_ptr<libtorrent::peer_plugin> TorrentPlugin::new_connection(const l
 bool TorrentPlugin::isPeerBanned(const libtorrent::tcp::endpoint & endPoint) {
   bool banned = true;
 
-  if(_sentMalformedExtendedMessage.count(endPoint) && _policy.banPeersWithPastMalformedExtendedMessage)
-      std::clog << "Peer has previously sent malformed extended message." << std::endl;
-  else if(_misbehavedPeers.count(endPoint) && _policy.banPeersWithPastMisbehavior)
-      std::clog << "Peer has previously misbehaved." << std::endl;
-  else
+  if(_sentMalformedExtendedMessage.count(endPoint) && _policy.banPeersWithPastMalformedExtendedMessage) {
+      JOYSTREAM_EXTENSION_LOG(Info, "Peer has previously sent malformed extended message.");
+      metrics().peerBannedForMalformedMessages();
+  } else if(_misbehavedPeers.count(endPoint) && _policy.banPeersWithPastMisbehavior) {
+      JOYSTREAM_EXTENSION_LOG(Info, "Peer has previously misbehaved.");
+      metrics().peerBannedForMisbehavior();
+  } else
       banned = false;
 
   return banned;
@@ -119,7 +128,7 @@ void TorrentPlugin::peerStartedHandshake(PeerPlugin* peerPlugin) {
 
   // Disconnect banned endpoints
   if(isPeerBanned(endPoint)) {
-    std::clog << "dropping banned peer:" << libtorrent::print_endpoint(endPoint) << std::endl;
+    JOYSTREAM_EXTENSION_LOG(Info, "dropping banned peer:" << libtorrent::print_endpoint(endPoint));
     libtorrent::error_code ec;
     peerPlugin->drop(ec);
     return;
@@ -131,6 +140,8 @@ void TorrentPlugin::peerStartedHandshake(PeerPlugin* peerPlugin) {
   _peersCompletedHandshake[peerId] = _peersAwaitingHandshake[peerPlugin];
 
   _peersAwaitingHandshake.erase(peerPlugin);
+
+  markStatusChanged();
 }
 
 void TorrentPlugin::outgoingConnectionEstablished(PeerPlugin* peerPlugin) {
@@ -140,7 +151,7 @@ void TorrentPlugin::outgoingConnectionEstablished(PeerPlugin* peerPlugin) {
 void TorrentPlugin::peerDisconnected(PeerPlugin* peerPlugin, libtorrent::error_code const & ec) {
   auto endPoint = peerPlugin->endPoint();
 
-  std::clog << "peer disconnected " << libtorrent::print_endpoint(endPoint)<< " " << ec.message().c_str() << std::endl;
+  JOYSTREAM_EXTENSION_LOG(Debug, "peer disconnected " << libtorrent::print_endpoint(endPoint)<< " " << ec.message().c_str());
 
   if(_peersAwaitingHandshake.count(peerPlugin)) {
     _peersAwaitingHandshake.erase(peerPlugin);
@@ -148,6 +159,8 @@ void TorrentPlugin::peerDisconnected(PeerPlugin* peerPlugin, libtorrent::error_c
     auto peerId = peerPlugin->connection().pid();
     removeFromSession(peerPlugin);
     _peersCompletedHandshake.erase(peerId);
+
+    markStatusChanged();
   }
 }
 
@@ -170,6 +183,8 @@ void TorrentPlugin::on_piece_pass(int index) {
     // Make sure we are in correct mode, as mode changed may have occured
     if(_session.mode() == protocol_session::SessionMode::buying) {
         _session.pieceDownloaded(index);
+
+        markStatusChanged();
     }
 }
 
@@ -182,6 +197,22 @@ void TorrentPlugin::tick() {
     // Asynch processing in session if its setup
     if(_session.mode() != protocol_session::SessionMode::not_set) {
         _session.tick();
+
+        // Status is not marked changed here, as that would include all active
+        // torrents in every status delta. Any change by session shows up as a
+        // message sent, see PeerPlugin::messageSent, or through its callbacks.
+    }
+
+    publishStatus();
+
+    if(_policy.aggregatedAlerts != 0) {
+
+        const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+        if(now >= _nextAggregatedEventsAlert) {
+            postAggregatedEvents();
+            _nextAggregatedEventsAlert = now + _policy.alertAggregationInterval;
+        }
     }
 }
 
@@ -213,14 +244,14 @@ void TorrentPlugin::on_add_peer(const libtorrent::tcp::endpoint & endPoint, int
     // Check if we know from before that peer does not have
     if(_withoutExtension.find(endPoint) != _withoutExtension.end()) {
 
-        std::clog << "Not connecting to peer" << endPointString.c_str() << "which is known to not have extension.";
+        JOYSTREAM_EXTENSION_LOG(Debug, "Not connecting to peer" << endPointString.c_str() << "which is known to not have extension.");
         return;
     }
 
     // Check if peer is banned due to irregular behaviour
     if(_irregularPeer.find(endPoint) != _irregularPeer.end()) {
 
-        std::clog << "Not connecting to peer" << endPointString.c_str() << "which has been banned due to irregular behaviour.";
+        JOYSTREAM_EXTENSION_LOG(Debug, "Not connecting to peer" << endPointString.c_str() << "which has been banned due to irregular behaviour.");
         return;
     }
 
@@ -241,7 +272,7 @@ void TorrentPlugin::pieceRead(const libtorrent::read_piece_alert * alert) {
 
     if(it == _outstandingLoadPieceForBuyers.cend()) {
 
-        std::clog << "Ignoring piece read, must be for some other purpose." << std::endl;
+        JOYSTREAM_EXTENSION_LOG(Debug, "Ignoring piece read, must be for some other purpose.");
         return;
     }
 
@@ -251,15 +282,20 @@ void TorrentPlugin::pieceRead(const libtorrent::read_piece_alert * alert) {
     // Make sure reading worked
     if(alert->ec) {
 
-        std::clog << "Failed reading piece" << alert->piece << std::endl;
+        JOYSTREAM_EXTENSION_LOG(Warning, "Failed reading piece" << alert->piece);
+        metrics().pieceLoadFailed();
         assert(false);
 
     } else {
 
         // std::clog << "Read piece" << alert->piece << std::endl;
 
+        metrics().pieceLoaded();
+
         // tell session
         _session.pieceLoaded(protocol_wire::PieceData(alert->buffer, alert->size), alert->piece);
+
+        markStatusChanged();
     }
 }
 
@@ -270,6 +306,8 @@ void TorrentPlugin::start() {
     // Start session
     _session.start();
 
+    markStatusChanged();
+
     // Send notification
     _alertManager->emplace_alert<alert::SessionStarted>(_torrent);
 
@@ -312,6 +350,11 @@ void TorrentPlugin::stop() {
     // as we don't initate it in callback from session.
     _session.stop();
 
+    markStatusChanged();
+
+    // Events from before stop are summarized before it is announced
+    postAggregatedEvents();
+
     // Send notification
     _alertManager->emplace_alert<alert::SessionStopped>(_torrent);
 
@@ -330,6 +373,8 @@ void TorrentPlugin::pause() {
 
     _session.pause();
 
+    markStatusChanged();
+
     // Send notification
     _alertManager->emplace_alert<alert::SessionPaused>(_torrent);
 }
@@ -338,6 +383,8 @@ void TorrentPlugin::updateTerms(const protocol_wire::SellerTerms & terms) {
 
     _session.updateTerms(terms);
 
+    markStatusChanged();
+
     // Send notification
     _alertManager->emplace_alert<alert::SellerTermsUpdated>(_torrent, terms);
 }
@@ -346,6 +393,8 @@ void TorrentPlugin::updateTerms(const protocol_wire::BuyerTerms & terms) {
 
     _session.updateTerms(terms);
 
+    markStatusChanged();
+
     // Send notification
     _alertManager->emplace_alert<alert::BuyerTermsUpdated>(_torrent, terms);
 }
@@ -359,6 +408,8 @@ void TorrentPlugin::toObserveMode() {
 
     _session.toObserveMode(removeConnection());
 
+    markStatusChanged();
+
     // Send notification
     _alertManager->emplace_alert<alert::SessionToObserveMode>(_torrent);
 }
@@ -385,6 +436,8 @@ void TorrentPlugin::toSellMode(const protocol_wire::SellerTerms & terms) {
                         terms,
                         maxPieceIndex);
 
+    markStatusChanged();
+
 
     // Send notification
     _alertManager->emplace_alert<alert::SessionToSellMode>(_torrent, terms);
@@ -408,6 +461,8 @@ void TorrentPlugin::toBuyMode(const protocol_wire::BuyerTerms & terms) {
                        torrentPieceInformation(),
                        allSellersGone());
 
+    markStatusChanged();
+
     // Send notification
     _alertManager->emplace_alert<alert::SessionToBuyMode>(_torrent, terms);
 }
@@ -417,6 +472,8 @@ void TorrentPlugin::startDownloading(const Coin::Transaction & contractTx,
 
     _session.startDownloading(contractTx, peerToStartDownloadInformationMap, std::bind(&TorrentPlugin::pickNextPiece, this, std::placeholders::_1));
 
+    markStatusChanged();
+
     // Send notification
     _alertManager->emplace_alert<alert::DownloadStarted>(_torrent, contractTx, peerToStartDownloadInformationMap);
 }
@@ -428,6 +485,8 @@ void TorrentPlugin::startUploading(const libtorrent::peer_id & peerId,
 
     _session.startUploading(peerId, terms, contractKeyPair, finalPkHash);
 
+    markStatusChanged();
+
     // Send notification
     _alertManager->emplace_alert<alert::UploadStarted>(_torrent, peerId, terms, contractKeyPair, finalPkHash);
 
@@ -439,7 +498,119 @@ std::map<libtorrent::peer_id, boost::weak_ptr<PeerPlugin> > TorrentPlugin::peers
 
 status::TorrentPlugin TorrentPlugin::status() const {
 
-    return status::TorrentPlugin(_infoHash, _session.status(), libtorrentInteraction());
+    status::TorrentPlugin status(_infoHash, _session.status(), libtorrentInteraction());
+
+    status.transfer = _transfer.status(std::chrono::steady_clock::now());
+
+    return status;
+}
+
+uint64_t TorrentPlugin::statusGeneration() const noexcept {
+    return _statusGeneration;
+}
+
+std::map<libtorrent::peer_id, status::PeerPlugin> TorrentPlugin::peerStatuses(const PeerStatusQuery & query,
+                                                                              boost::optional<libtorrent::peer_id> * nextCursor) const {
+
+    std::map<libtorrent::peer_id, status::PeerPlugin> statuses;
+
+    if(nextCursor)
+        *nextCursor = boost::none;
+
+    // ** quick fix, guards against ::hasConnection and ::connectionStatus calls below
+    const bool sessionModeSet = (_session.mode() != protocol_session::SessionMode::not_set);
+
+    const bool includeConnectionStatus = (query.fields & PeerStatusQuery::ConnectionStatus) != 0;
+    const bool sessionConnectionRequired = query.inSessionOnly || query.connectionFilter;
+
+    // Peers are ordered by id, so cursor is found without scanning
+    auto it = query.cursor ? _peersCompletedHandshake.upper_bound(*query.cursor) : _peersCompletedHandshake.cbegin();
+
+    for(;it != _peersCompletedHandshake.cend();it++) {
+
+        const libtorrent::peer_id & peerId = it->first;
+
+        boost::shared_ptr<PeerPlugin> peerPlugin = it->second.lock();
+
+        assert(peerPlugin);
+
+        // Cheap filters first
+        if(query.peerBEP10SupportStatus && peerPlugin->peerBEP10SupportStatus() != *query.peerBEP10SupportStatus)
+            continue;
+
+        if(query.peerPaymentBEPSupportStatus && peerPlugin->peerPaymentBEPSupportStatus() != *query.peerPaymentBEPSupportStatus)
+            continue;
+
+        const bool inSession = (sessionConnectionRequired || includeConnectionStatus) && sessionModeSet && _session.hasConnection(peerId);
+
+        if(sessionConnectionRequired && !inSession)
+            continue;
+
+        boost::optional<protocol_session::status::Connection<libtorrent::peer_id>> connectionStatus;
+
+        if(inSession && (includeConnectionStatus || query.connectionFilter)) {
+
+            connectionStatus = _session.connectionStatus(peerId);
+
+            if(query.connectionFilter && !query.connectionFilter(*connectionStatus))
+                continue;
+
+            if(!includeConnectionStatus)
+                connectionStatus = boost::none;
+        }
+
+        // Page is full, and there is at least one more match
+        if(query.maxCount > 0 && statuses.size() == query.maxCount) {
+
+            if(nextCursor)
+                *nextCursor = statuses.crbegin()->first;
+
+            break;
+        }
+
+        statuses.insert(statuses.cend(), std::make_pair(peerId, peerPlugin->status(connectionStatus)));
+    }
+
+    return statuses;
+}
+
+const std::shared_ptr<TorrentPlugin::PublishedStatus> & TorrentPlugin::publishedStatus() const noexcept {
+    return _publishedStatus;
+}
+
+void TorrentPlugin::publishStatus() {
+
+    if(_publishedStatusGeneration == _statusGeneration)
+        return;
+
+    std::shared_ptr<const status::TorrentPluginSnapshot> snapshot = std::make_shared<status::TorrentPluginSnapshot>(status(), peerStatuses(), _statusGeneration);
+
+    // Readers holding previous snapshot keep it alive until they are done
+    std::atomic_store(&_publishedStatus->snapshot, std::move(snapshot));
+
+    _publishedStatusGeneration = _statusGeneration;
+}
+
+void TorrentPlugin::exportStatus(status::ColumnarStatus & columns, const std::chrono::steady_clock::time_point & now) const {
+
+    // ** quick fix, guards against ::hasConnection call below
+    const bool sessionModeSet = (_session.mode() != protocol_session::SessionMode::not_set);
+
+    columns.torrentInfoHash.push_back(_infoHash);
+    columns.torrentSessionMode.push_back(static_cast<uint8_t>(_session.mode()));
+    columns.torrentLibtorrentInteraction.push_back(static_cast<uint8_t>(_libtorrentInteraction));
+    columns.torrentFirstPeer.push_back(static_cast<uint32_t>(columns.peerId.size()));
+    columns.torrentPeerCount.push_back(static_cast<uint32_t>(_peersCompletedHandshake.size()));
+    columns.torrentTransfer.append(_transfer.status(now));
+
+    for(const auto & mapping : _peersCompletedHandshake) {
+
+        boost::shared_ptr<PeerPlugin> peerPlugin = mapping.second.lock();
+
+        assert(peerPlugin);
+
+        peerPlugin->exportStatus(columns, sessionModeSet && _session.hasConnection(mapping.first), now);
+    }
 }
 
 TorrentPlugin::LibtorrentInteraction TorrentPlugin::libtorrentInteraction() const {
@@ -493,6 +664,8 @@ protocol_session::TorrentPieceInformation TorrentPlugin::torrentPieceInformation
 
 void TorrentPlugin::setLibtorrentInteraction(LibtorrentInteraction e) {
     _libtorrentInteraction = e;
+
+    markStatusChanged();
 }
 
 void TorrentPlugin::dropPeer (const libtorrent::peer_id & peerId) {
@@ -611,10 +784,22 @@ void TorrentPlugin::addToSession(PeerPlugin* peerPlugin) {
     // add peer to sesion
     _session.addConnection(peerId, send);
 
+    peerPlugin->flightRecorder().record(FlightRecord::Kind::AddedToSession);
+
+    markStatusChanged();
+
     // Send notification
     auto connectionStatus = _session.connectionStatus(peerId);
     auto endPoint = peerPlugin->endPoint();
-    _alertManager->emplace_alert<alert::ConnectionAddedToSession>(_torrent, endPoint, peerId, connectionStatus);
+
+    if(aggregates(Policy::ConnectionAddedToSession)) {
+
+        status::PeerEvents & events = aggregatedEvents(peerId, endPoint);
+        events.connectionsAddedToSession++;
+        events.connection = connectionStatus;
+
+    } else
+        _alertManager->emplace_alert<alert::ConnectionAddedToSession>(_torrent, endPoint, peerId, connectionStatus);
 }
 
 bool TorrentPlugin::peerInSession(PeerPlugin* peerPlugin) {
@@ -632,9 +817,56 @@ void TorrentPlugin::removeFromSession(PeerPlugin* peerPlugin) {
 
   if(peerInSession(peerPlugin)) {
     _session.removeConnection(peerPlugin->connection().pid());
+
+    markStatusChanged();
   }
 }
 
+void TorrentPlugin::markStatusChanged() {
+    _statusGeneration = _plugin->nextStatusGeneration();
+}
+
+Metrics & TorrentPlugin::metrics() const {
+    return _plugin->_metrics;
+}
+
+SendBufferPool & TorrentPlugin::sendBufferPool() const {
+    return _plugin->_sendBufferPool;
+}
+
+status::MessageLatency & TorrentPlugin::messageLatency(MessageType messageType) const {
+    return _plugin->_messageLatencies[static_cast<std::size_t>(messageType)];
+}
+
+bool TorrentPlugin::aggregates(Policy::AggregatedAlert aggregatedAlert) const {
+    return (_policy.aggregatedAlerts & aggregatedAlert) != 0;
+}
+
+status::PeerEvents & TorrentPlugin::aggregatedEvents(const libtorrent::peer_id & peerId, const libtorrent::tcp::endpoint & endPoint) {
+
+    status::PeerEvents & events = _aggregatedEvents[peerId];
+    events.endPoint = endPoint;
+
+    return events;
+}
+
+void TorrentPlugin::transferred(TransferEvent event, uint64_t amount, const std::chrono::steady_clock::time_point & now) {
+
+    _transfer.record(event, amount, now);
+    _plugin->_transfer.record(event, amount, now);
+}
+
+void TorrentPlugin::postAggregatedEvents() {
+
+    if(_aggregatedEvents.empty())
+        return;
+
+    std::map<libtorrent::peer_id, status::PeerEvents> events;
+    events.swap(_aggregatedEvents);
+
+    _alertManager->emplace_alert<alert::AggregatedPeerEventsAlert>(_torrent, std::move(events));
+}
+
 protocol_session::RemovedConnectionCallbackHandler<libtorrent::peer_id> TorrentPlugin::removeConnection() {
 
     return [this](const libtorrent::peer_id & peerId, protocol_session::DisconnectCause cause) {
@@ -642,8 +874,16 @@ protocol_session::RemovedConnectionCallbackHandler<libtorrent::peer_id> TorrentP
         auto peerPlugin = peer(peerId);
         auto endPoint = peerPlugin->endPoint();
 
+        // Aggregated events happened before removal, so must not arrive after it
+        if(_aggregatedEvents.count(peerId) > 0)
+            postAggregatedEvents();
+
         _alertManager->emplace_alert<alert::ConnectionRemovedFromSession>(_torrent, endPoint, peerId);
 
+        peerPlugin->flightRecorder().record(FlightRecord::Kind::RemovedFromSession, static_cast<uint8_t>(cause));
+
+        markStatusChanged();
+
         // If the client was cause, then no further processing is required.
         // The callback is then a result of the stupid convention that Session::removeConnection()/stop()
         // triggers callback.
@@ -659,9 +899,11 @@ protocol_session::RemovedConnectionCallbackHandler<libtorrent::peer_id> TorrentP
               cause == protocol_session::DisconnectCause::buyer_requested_too_many_speed_tests ||
               cause == protocol_session::DisconnectCause::buyer_speed_test_payload_requested_too_large) {
 
-                std::clog << "Adding peer to misbehavedPeers list: " << endPoint << " cause: " << (int)cause << std::endl;
+                JOYSTREAM_EXTENSION_LOG(Info, "Adding peer to misbehavedPeers list: " << endPoint << " cause: " << (int)cause);
                 _misbehavedPeers.insert(endPoint);
 
+                peerPlugin->flightRecorder().record(FlightRecord::Kind::Banned, static_cast<uint8_t>(cause));
+
           } else {
             // For all other less severe disconnect causes
             // add peer to temporary ban list?
@@ -684,9 +926,11 @@ protocol_session::FullPieceArrived<libtorrent::peer_id> TorrentPlugin::fullPiece
 
         const auto ti = torrent()->torrent_file();
 
-        // test if piece data is valid
+        // test if piece data is valid, hash was normally taken by peer plugin as data arrived
         const libtorrent::sha1_hash expected = ti.hash_for_piece(index);
-        const libtorrent::sha1_hash computed = libtorrent::hasher(pieceData.piece().get(), pieceData.length()).final();
+        const libtorrent::sha1_hash computed = peerPlugin->pieceDataHash(pieceData);
+
+        metrics().pieceArrived(computed == expected);
 
         if (computed != expected) {
           _alertManager->emplace_alert<alert::InvalidPieceArrived>(_torrent, endPoint, peerId, index);
@@ -708,7 +952,14 @@ protocol_session::FullPieceArrived<libtorrent::peer_id> TorrentPlugin::fullPiece
           // We already received the piece from another peer (most likely a non joystream peer)
         }
 
-        _alertManager->emplace_alert<alert::ValidPieceArrived>(_torrent, endPoint, peerId, index);
+        if(aggregates(Policy::ValidPieceArrived)) {
+
+            status::PeerEvents & events = aggregatedEvents(peerId, endPoint);
+            events.validPiecesArrived++;
+            events.lastArrivedPieceIndex = index;
+
+        } else
+            _alertManager->emplace_alert<alert::ValidPieceArrived>(_torrent, endPoint, peerId, index);
 
         return true;
     };
@@ -731,22 +982,20 @@ protocol_session::LoadPieceForBuyer<libtorrent::peer_id> TorrentPlugin::loadPiec
           // same call triggering re-entry into hanlding read_piece_alert which checks this set
           this->_outstandingLoadPieceForBuyers.insert(index);
 
-          std::clog << "Requested piece "
-                    << index
-                    << " by"
-                    << libtorrent::print_address(endPoint.address()).c_str()
-                    << std::endl;
+          JOYSTREAM_EXTENSION_LOG(Debug, "Requested piece "
+                                  << index
+                                  << " by"
+                                  << libtorrent::print_address(endPoint.address()).c_str());
 
           // Make first call
           torrent()->read_piece(index);
 
         } else {
             // We dont need to make a new call, a response will come from libtorrent
-            std::clog << "Skipping reading of requested piece "
-                      << index
-                      << " by"
-                      << libtorrent::print_address(endPoint.address()).c_str()
-                      << std::endl;
+            JOYSTREAM_EXTENSION_LOG(Debug, "Skipping reading of requested piece "
+                                    << index
+                                    << " by"
+                                    << libtorrent::print_address(endPoint.address()).c_str());
         }
     };
 }
@@ -765,6 +1014,8 @@ protocol_session::ClaimLastPayment<libtorrent::peer_id> TorrentPlugin::claimLast
 
         // Send alert about this being last payment
         manager.emplace_alert<alert::LastPaymentReceived>(h, endPoint, peerId, payee);
+
+        markStatusChanged();
     };
 }
 
@@ -790,9 +1041,21 @@ protocol_session::ReceivedValidPayment<libtorrent::peer_id> TorrentPlugin::recei
 
     return [&manager, h, this](const libtorrent::peer_id & peerId, uint64_t paymentIncrement, uint64_t totalNumberOfPayments, uint64_t totalAmountPaid) {
 
-        auto endPoint = peer(peerId)->endPoint();
+        auto peerPlugin = peer(peerId);
+        auto endPoint = peerPlugin->endPoint();
+
+        peerPlugin->transferred(TransferEvent::PaymentReceived, paymentIncrement);
+
+        if(aggregates(Policy::ValidPaymentReceived)) {
+
+            status::PeerEvents & events = aggregatedEvents(peerId, endPoint);
+            events.validPaymentsReceived++;
+            events.amountReceived += paymentIncrement;
+            events.totalNumberOfPaymentsReceived = totalNumberOfPayments;
+            events.totalAmountReceived = totalAmountPaid;
 
-        manager.emplace_alert<alert::ValidPaymentReceived>(h, endPoint, peerId, paymentIncrement, totalNumberOfPayments, totalAmountPaid);
+        } else
+            manager.emplace_alert<alert::ValidPaymentReceived>(h, endPoint, peerId, paymentIncrement, totalNumberOfPayments, totalAmountPaid);
     };
 }
 
@@ -805,9 +1068,22 @@ protocol_session::SentPayment<libtorrent::peer_id> TorrentPlugin::sentPayment()
 
     return [&manager, h, this](const libtorrent::peer_id & peerId, uint64_t paymentIncrement, uint64_t totalNumberOfPayments, uint64_t totalAmountPaid, int pieceIndex) {
 
-        auto endPoint = peer(peerId)->endPoint();
+        auto peerPlugin = peer(peerId);
+        auto endPoint = peerPlugin->endPoint();
+
+        peerPlugin->transferred(TransferEvent::PaymentSent, paymentIncrement);
 
-        manager.emplace_alert<alert::SentPayment>(h, endPoint, peerId, paymentIncrement, totalNumberOfPayments, totalAmountPaid, pieceIndex);
+        if(aggregates(Policy::SentPayment)) {
+
+            status::PeerEvents & events = aggregatedEvents(peerId, endPoint);
+            events.paymentsSent++;
+            events.amountSent += paymentIncrement;
+            events.totalNumberOfPaymentsSent = totalNumberOfPayments;
+            events.totalAmountSent = totalAmountPaid;
+            events.lastPaidPieceIndex = pieceIndex;
+
+        } else
+            manager.emplace_alert<alert::SentPayment>(h, endPoint, peerId, paymentIncrement, totalNumberOfPayments, totalAmountPaid, pieceIndex);
     };
 
 }
@@ -820,6 +1096,8 @@ protocol_session::AllSellersGone TorrentPlugin::allSellersGone() {
 
   return [&manager, h, this](void) -> void {
     manager.emplace_alert<alert::AllSellersGone>(h);
+
+    markStatusChanged();
   };
 }
 
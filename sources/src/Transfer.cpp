@@ -0,0 +1,73 @@
+/**
+ * Copyright (C) JoyStream - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#include <extension/Transfer.hpp>
+
+#include <cmath>
+
+namespace joystream {
+namespace extension {
+
+RateEstimator::RateEstimator()
+    : _rate(0) {
+}
+
+void RateEstimator::add(double amount, const std::chrono::steady_clock::time_point & now) {
+
+    // Decay to now, then add contribution of new amount
+    _rate = rate(now) + amount / TransferAccounting::timeConstant;
+    _updated = now;
+}
+
+double RateEstimator::rate(const std::chrono::steady_clock::time_point & now) const {
+
+    if(_rate == 0)
+        return 0;
+
+    const double age = std::chrono::duration<double>(now - _updated).count();
+
+    return _rate * std::exp(-age / TransferAccounting::timeConstant);
+}
+
+constexpr double TransferAccounting::timeConstant;
+
+void TransferAccounting::record(TransferEvent event, uint64_t amount, const std::chrono::steady_clock::time_point & now) {
+
+    Flow & flow = _flows[static_cast<std::size_t>(event)];
+
+    flow.count++;
+    flow.amount += amount;
+
+    flow.countRate.add(1, now);
+    flow.amountRate.add(amount, now);
+}
+
+status::Transfer TransferAccounting::status(const std::chrono::steady_clock::time_point & now) const {
+
+    status::Transfer transfer;
+
+    transfer.piecesSent = status(_flows[static_cast<std::size_t>(TransferEvent::PieceSent)], now);
+    transfer.piecesReceived = status(_flows[static_cast<std::size_t>(TransferEvent::PieceReceived)], now);
+    transfer.paymentsSent = status(_flows[static_cast<std::size_t>(TransferEvent::PaymentSent)], now);
+    transfer.paymentsReceived = status(_flows[static_cast<std::size_t>(TransferEvent::PaymentReceived)], now);
+
+    return transfer;
+}
+
+status::TransferFlow TransferAccounting::status(const Flow & flow, const std::chrono::steady_clock::time_point & now) const {
+
+    status::TransferFlow transferFlow;
+
+    transferFlow.count = flow.count;
+    transferFlow.amount = flow.amount;
+    transferFlow.countRate = flow.countRate.rate(now);
+    transferFlow.amountRate = flow.amountRate.rate(now);
+
+    return transferFlow;
+}
+
+}
+}
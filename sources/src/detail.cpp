@@ -14,105 +14,167 @@ namespace joystream {
 namespace extension {
 namespace detail {
 
-void RequestVariantVisitor::operator()(const request::Start & r) {
+struct RequestTypeNameVisitor : public boost::static_visitor<const char *> {
+
+    const char * operator()(const request::Start &) const { return "Start"; }
+    const char * operator()(const request::Stop &) const { return "Stop"; }
+    const char * operator()(const request::Pause &) const { return "Pause"; }
+    const char * operator()(const request::UpdateBuyerTerms &) const { return "UpdateBuyerTerms"; }
+    const char * operator()(const request::UpdateSellerTerms &) const { return "UpdateSellerTerms"; }
+    const char * operator()(const request::ToObserveMode &) const { return "ToObserveMode"; }
+    const char * operator()(const request::ToSellMode &) const { return "ToSellMode"; }
+    const char * operator()(const request::ToBuyMode &) const { return "ToBuyMode"; }
+    const char * operator()(const request::PostTorrentPluginStatusUpdates &) const { return "PostTorrentPluginStatusUpdates"; }
+    const char * operator()(const request::PostPeerPluginStatusUpdates &) const { return "PostPeerPluginStatusUpdates"; }
+    const char * operator()(const request::PostRequestLatencyStatistics &) const { return "PostRequestLatencyStatistics"; }
+    const char * operator()(const request::PostMessageLatencyStatistics &) const { return "PostMessageLatencyStatistics"; }
+    const char * operator()(const request::ExportStatus &) const { return "ExportStatus"; }
+    const char * operator()(const request::StopAllTorrentPlugins &) const { return "StopAllTorrentPlugins"; }
+    const char * operator()(const request::PauseLibtorrent &) const { return "PauseLibtorrent"; }
+    const char * operator()(const request::AddTorrent &) const { return "AddTorrent"; }
+    const char * operator()(const request::RemoveTorrent &) const { return "RemoveTorrent"; }
+    const char * operator()(const request::PauseTorrent &) const { return "PauseTorrent"; }
+    const char * operator()(const request::ResumeTorrent &) const { return "ResumeTorrent"; }
+    const char * operator()(const request::StartDownloading &) const { return "StartDownloading"; }
+    const char * operator()(const request::StartUploading &) const { return "StartUploading"; }
+    const char * operator()(const request::SetLibtorrentInteraction &) const { return "SetLibtorrentInteraction"; }
+    const char * operator()(const request::DropPeer &) const { return "DropPeer"; }
+    const char * operator()(const RequestBatch &) const { return "Batch"; }
+};
+
+const char * requestTypeName(const RequestVariant & v) {
+    return boost::apply_visitor(RequestTypeNameVisitor(), v);
+}
+
+struct RequestTorrentVisitor : public boost::static_visitor<const libtorrent::sha1_hash *> {
+
+    template<class T>
+    const libtorrent::sha1_hash * operator()(const T &) const { return nullptr; }
+
+    const libtorrent::sha1_hash * operator()(const request::Start & r) const { return &r.infoHash; }
+    const libtorrent::sha1_hash * operator()(const request::Stop & r) const { return &r.infoHash; }
+    const libtorrent::sha1_hash * operator()(const request::Pause & r) const { return &r.infoHash; }
+    const libtorrent::sha1_hash * operator()(const request::UpdateBuyerTerms & r) const { return &r.infoHash; }
+    const libtorrent::sha1_hash * operator()(const request::UpdateSellerTerms & r) const { return &r.infoHash; }
+    const libtorrent::sha1_hash * operator()(const request::ToObserveMode & r) const { return &r.infoHash; }
+    const libtorrent::sha1_hash * operator()(const request::ToSellMode & r) const { return &r.infoHash; }
+    const libtorrent::sha1_hash * operator()(const request::ToBuyMode & r) const { return &r.infoHash; }
+    const libtorrent::sha1_hash * operator()(const request::RemoveTorrent & r) const { return &r.infoHash; }
+    const libtorrent::sha1_hash * operator()(const request::PauseTorrent & r) const { return &r.infoHash; }
+    const libtorrent::sha1_hash * operator()(const request::ResumeTorrent & r) const { return &r.infoHash; }
+    const libtorrent::sha1_hash * operator()(const request::StartDownloading & r) const { return &r.infoHash; }
+    const libtorrent::sha1_hash * operator()(const request::StartUploading & r) const { return &r.infoHash; }
+    const libtorrent::sha1_hash * operator()(const request::SetLibtorrentInteraction & r) const { return &r.infoHash; }
+    const libtorrent::sha1_hash * operator()(const request::DropPeer & r) const { return &r.infoHash; }
+};
+
+const libtorrent::sha1_hash * requestTorrent(const RequestVariant & v) {
+    return boost::apply_visitor(RequestTorrentVisitor(), v);
+}
+
+void RequestVariantVisitor::operator()(request::Start & r) {
 
     auto e = runTorrentPluginRequest(r.infoHash, [](const boost::shared_ptr<TorrentPlugin> & plugin) {
         plugin->start();
     });
 
-    sendRequestResult(std::bind(r.handler, e));
+    sendRequestResult(bindHandler(std::move(r.handler), e), e);
 }
 
-void RequestVariantVisitor::operator()(const request::Stop & r) {
+void RequestVariantVisitor::operator()(request::Stop & r) {
 
     auto e = runTorrentPluginRequest(r.infoHash, [](const boost::shared_ptr<TorrentPlugin> & plugin) {
         plugin->stop();
     });
 
-    sendRequestResult(std::bind(r.handler, e));
+    sendRequestResult(bindHandler(std::move(r.handler), e), e);
 }
 
-void RequestVariantVisitor::operator()(const request::Pause & r) {
+void RequestVariantVisitor::operator()(request::Pause & r) {
 
     auto e = runTorrentPluginRequest(r.infoHash, [](const boost::shared_ptr<TorrentPlugin> & plugin) {
         plugin->pause();
     });
 
-    sendRequestResult(std::bind(r.handler, e));
+    sendRequestResult(bindHandler(std::move(r.handler), e), e);
 }
 
-void RequestVariantVisitor::operator()(const request::UpdateBuyerTerms & r) {
+void RequestVariantVisitor::operator()(request::UpdateBuyerTerms & r) {
 
-    auto e = runTorrentPluginRequest(r.infoHash, [r](const boost::shared_ptr<TorrentPlugin> & plugin) {
+    auto e = runTorrentPluginRequest(r.infoHash, [&r](const boost::shared_ptr<TorrentPlugin> & plugin) {
         plugin->updateTerms(r.terms);
     });
 
-    sendRequestResult(std::bind(r.handler, e));
+    sendRequestResult(bindHandler(std::move(r.handler), e), e);
 }
 
-void RequestVariantVisitor::operator()(const request::UpdateSellerTerms & r) {
+void RequestVariantVisitor::operator()(request::UpdateSellerTerms & r) {
 
-    auto e = runTorrentPluginRequest(r.infoHash, [r](const boost::shared_ptr<TorrentPlugin> & plugin) {
+    auto e = runTorrentPluginRequest(r.infoHash, [&r](const boost::shared_ptr<TorrentPlugin> & plugin) {
         plugin->updateTerms(r.terms);
     });
 
-    sendRequestResult(std::bind(r.handler, e));
+    sendRequestResult(bindHandler(std::move(r.handler), e), e);
 }
 
-void RequestVariantVisitor::operator()(const request::ToObserveMode & r) {
+void RequestVariantVisitor::operator()(request::ToObserveMode & r) {
 
-    auto e = runTorrentPluginRequest(r.infoHash, [r](const boost::shared_ptr<TorrentPlugin> & plugin) {
+    auto e = runTorrentPluginRequest(r.infoHash, [&r](const boost::shared_ptr<TorrentPlugin> & plugin) {
         plugin->toObserveMode();
     });
 
-    sendRequestResult(std::bind(r.handler, e));
+    sendRequestResult(bindHandler(std::move(r.handler), e), e);
 }
 
-void RequestVariantVisitor::operator()(const request::ToSellMode & r) {
+void RequestVariantVisitor::operator()(request::ToSellMode & r) {
 
-    auto e = runTorrentPluginRequest(r.infoHash, [r](const boost::shared_ptr<TorrentPlugin> & plugin) {
+    auto e = runTorrentPluginRequest(r.infoHash, [&r](const boost::shared_ptr<TorrentPlugin> & plugin) {
         plugin->toSellMode(r.terms);
     });
 
-    sendRequestResult(std::bind(r.handler, e));
+    sendRequestResult(bindHandler(std::move(r.handler), e), e);
 }
 
-void RequestVariantVisitor::operator()(const request::ToBuyMode & r) {
+void RequestVariantVisitor::operator()(request::ToBuyMode & r) {
 
-    auto e = runTorrentPluginRequest(r.infoHash, [r](const boost::shared_ptr<TorrentPlugin> & plugin) {
+    auto e = runTorrentPluginRequest(r.infoHash, [&r](const boost::shared_ptr<TorrentPlugin> & plugin) {
         plugin->toBuyMode(r.terms);
     });
 
-    sendRequestResult(std::bind(r.handler, e));
+    sendRequestResult(bindHandler(std::move(r.handler), e), e);
 }
 
-void RequestVariantVisitor::operator()(const request::PostTorrentPluginStatusUpdates &) {
+void RequestVariantVisitor::operator()(request::PostTorrentPluginStatusUpdates & r) {
 
     /// TEMPORARY: FACTOR OUT LATER
 
-    // Generate all statuses
+    // Generate statuses, of all plugins, or only those changed since given generation
     std::map<libtorrent::sha1_hash, status::TorrentPlugin> statuses;
 
-    const std::map<libtorrent::sha1_hash, boost::weak_ptr<TorrentPlugin> > torrentPlugins = _plugin->torrentPlugins();
+    const Plugin::TorrentPluginMap & torrentPlugins = _plugin->torrentPlugins();
 
-    for(auto m :torrentPlugins) {
+    for(const auto & m : torrentPlugins) {
 
         boost::shared_ptr<TorrentPlugin> torrentPlugin = m.second.lock();
 
         assert(torrentPlugin);
 
-        statuses.insert(std::make_pair(m.first, torrentPlugin->status()));
+        if(torrentPlugin->statusGeneration() > r.sinceGeneration)
+            statuses.insert(std::make_pair(m.first, torrentPlugin->status()));
     }
 
-    _alertManager->emplace_alert<alert::TorrentPluginStatusUpdateAlert>(statuses);
+    _alertManager->emplace_alert<alert::TorrentPluginStatusUpdateAlert>(std::move(statuses),
+                                                                        _plugin->_statusGeneration,
+                                                                        r.sinceGeneration,
+                                                                        _plugin->_transfer.status(std::chrono::steady_clock::now()));
 }
 
-void RequestVariantVisitor::operator()(const request::PostPeerPluginStatusUpdates & r) {
+void RequestVariantVisitor::operator()(request::PostPeerPluginStatusUpdates & r) {
 
     /// TEMPORARY: FACTOR OUT LATER
 
     // Get torrent plugin
-    const std::map<libtorrent::sha1_hash, boost::weak_ptr<TorrentPlugin> > torrentPlugins = _plugin->torrentPlugins();
+    const Plugin::TorrentPluginMap & torrentPlugins = _plugin->torrentPlugins();
 
     auto it = torrentPlugins.find(r._infoHash);
 
@@ -124,43 +186,71 @@ void RequestVariantVisitor::operator()(const request::PostPeerPluginStatusUpdate
 
     assert(torrentPlugin);
 
-    // ** quick fix, required to guard against ::connectionStatus calls below
+    // ** quick fix, no statuses until session mode is set
     if(torrentPlugin->session().mode() == protocol_session::SessionMode::not_set)
         return;
 
-    // Generate statuses for all peer plugins
-    std::map<libtorrent::peer_id, status::PeerPlugin> statuses;
+    // Generate statuses for peer plugins matching query
+    boost::optional<libtorrent::peer_id> nextCursor;
 
-    std::map<libtorrent::peer_id, boost::weak_ptr<PeerPlugin> > torrentPeerPlugins = torrentPlugin->peers();
+    std::map<libtorrent::peer_id, status::PeerPlugin> statuses = torrentPlugin->peerStatuses(r.query, &nextCursor);
 
-    for(auto m : torrentPeerPlugins) {
+    libtorrent::torrent_handle h = _session->find_torrent_handle(r._infoHash);
 
-        boost::optional<protocol_session::status::Connection<libtorrent::peer_id>> connectionStatus;
+    _alertManager->emplace_alert<alert::PeerPluginStatusUpdateAlert>(h, std::move(statuses), nextCursor);
+}
 
-        if (torrentPlugin->session().hasConnection(m.first)) {
-          // Get connection status corresponding to peer plugin
-          connectionStatus = torrentPlugin->session().connectionStatus(m.first);
-        }
+void RequestVariantVisitor::operator()(request::PostRequestLatencyStatistics &) {
 
-        // Generate peer plugin status, and add it to the map
-        boost::shared_ptr<PeerPlugin> peerPlugin = m.second.lock();
+    std::vector<status::RequestLatency> statistics;
 
-        assert(peerPlugin);
+    // Only types which have been seen
+    for(const status::RequestLatency & latency : _plugin->_requestLatencies)
+        if(latency.queueWait.count() > 0)
+            statistics.push_back(latency);
 
-        statuses.insert(std::make_pair(m.first, peerPlugin->status(connectionStatus)));
-    }
+    _alertManager->emplace_alert<alert::RequestLatencyStatisticsAlert>(std::move(statistics));
+}
 
-    libtorrent::torrent_handle h = _session->find_torrent_handle(r._infoHash);
+void RequestVariantVisitor::operator()(request::PostMessageLatencyStatistics &) {
+
+    std::vector<status::MessageLatency> statistics;
+
+    // Only types which have been seen
+    for(const status::MessageLatency & latency : _plugin->_messageLatencies)
+        if(latency.parse.count() > 0 || latency.send.count() > 0)
+            statistics.push_back(latency);
+
+    _alertManager->emplace_alert<alert::MessageLatencyStatisticsAlert>(std::move(statistics));
+}
+
+void RequestVariantVisitor::operator()(request::ExportStatus & r) {
+
+    std::shared_ptr<status::ColumnarStatus> columns = r.columns ? std::move(r.columns) : std::make_shared<status::ColumnarStatus>();
+
+    columns->clear();
+    columns->generation = _plugin->_statusGeneration;
 
-    _alertManager->emplace_alert<alert::PeerPluginStatusUpdateAlert>(h, statuses);
+    // Same point in time for all rates
+    const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+    for(const auto & m : _plugin->torrentPlugins()) {
+
+        boost::shared_ptr<TorrentPlugin> plugin = m.second.lock();
+
+        if(plugin)
+            plugin->exportStatus(*columns, now);
+    }
+
+    sendRequestResult(bindHandler(std::move(r.handler), std::move(columns)));
 }
 
-void RequestVariantVisitor::operator()(const request::StopAllTorrentPlugins & r) {
+void RequestVariantVisitor::operator()(request::StopAllTorrentPlugins & r) {
 
     // Stop all torrent plugins which can be stopped
-    auto pluginMap = _plugin->torrentPlugins();
+    const auto & pluginMap = _plugin->torrentPlugins();
 
-    for(auto m : pluginMap) {
+    for(const auto & m : pluginMap) {
 
         boost::shared_ptr<TorrentPlugin> plugin = m.second.lock();
 
@@ -170,53 +260,56 @@ void RequestVariantVisitor::operator()(const request::StopAllTorrentPlugins & r)
     }
 
     // Send the result that we are done
-    sendRequestResult(r.handler);
+    sendRequestResult(std::move(r.handler));
 }
 
-void RequestVariantVisitor::operator()(const request::PauseLibtorrent & r) {
+void RequestVariantVisitor::operator()(request::PauseLibtorrent & r) {
 
     // Synchronous pause
     _session->pause();
 
     // Send the result that we are done
-    sendRequestResult(r.handler);
+    sendRequestResult(std::move(r.handler));
 }
 
-void RequestVariantVisitor::operator()(const request::AddTorrent & r) {
+void RequestVariantVisitor::operator()(request::AddTorrent & r) {
 
     libtorrent::error_code ec;
     libtorrent::torrent_handle h = _session->add_torrent(r.params, ec);
 
+    std::exception_ptr e;
+
+    if(ec)
+        e = std::make_exception_ptr(libtorrent::system_error(ec));
+
     // Bind to handler and send back to user
-    sendRequestResult(std::bind(r.handler, ec, h));
+    sendRequestResult(bindHandler(std::move(r.handler), ec, h), e);
 }
 
-void RequestVariantVisitor::operator()(const request::RemoveTorrent & r) {
+void RequestVariantVisitor::operator()(request::RemoveTorrent & r) {
 
     libtorrent::torrent_handle h = _session->find_torrent_handle(r.infoHash);
 
-    alert::LoadedCallback callback;
+    std::exception_ptr e;
 
     if(h.is_valid()) {
 
         // Remove torrent
         _session->remove_torrent(h, 0);
 
-        callback = std::bind(r.handler, std::exception_ptr());
-
     } else
-        callback = std::bind(r.handler, std::make_exception_ptr(exception::MissingTorrent()));
+        e = std::make_exception_ptr(exception::MissingTorrent());
 
     // Send back to user
-    sendRequestResult(callback);
+    sendRequestResult(bindHandler(std::move(r.handler), e), e);
 }
 
-void RequestVariantVisitor::operator()(const request::PauseTorrent & r) {
+void RequestVariantVisitor::operator()(request::PauseTorrent & r) {
 
     // Find torrent
     boost::weak_ptr<libtorrent::torrent> w = _session->find_torrent(r.infoHash);
 
-    alert::LoadedCallback callback;
+    std::exception_ptr e;
 
     // Pause if torrent was available, otherwise attach exception
     if(auto torrent = w.lock()) {
@@ -224,21 +317,19 @@ void RequestVariantVisitor::operator()(const request::PauseTorrent & r) {
         // Pause torrent
         torrent->pause(r.graceful);
 
-        callback = std::bind(r.handler, std::exception_ptr());
-
     } else
-        callback = std::bind(r.handler, std::make_exception_ptr(exception::MissingTorrent()));
+        e = std::make_exception_ptr(exception::MissingTorrent());
 
     // Send back to user
-    sendRequestResult(callback);
+    sendRequestResult(bindHandler(std::move(r.handler), e), e);
 }
 
-void RequestVariantVisitor::operator()(const request::ResumeTorrent & r) {
+void RequestVariantVisitor::operator()(request::ResumeTorrent & r) {
 
     // Find torrent
     boost::weak_ptr<libtorrent::torrent> w = _session->find_torrent(r.infoHash);
 
-    alert::LoadedCallback callback;
+    std::exception_ptr e;
 
     // Resume if torrent was available, otherwise attach exception
     if(auto torrent = w.lock()) {
@@ -246,55 +337,94 @@ void RequestVariantVisitor::operator()(const request::ResumeTorrent & r) {
         // Resume torrent
         torrent->resume();
 
-        callback = std::bind(r.handler, std::exception_ptr());
-
     } else
-        callback = std::bind(r.handler, std::make_exception_ptr(exception::MissingTorrent()));
+        e = std::make_exception_ptr(exception::MissingTorrent());
 
     // Send back to user
-    sendRequestResult(callback);
+    sendRequestResult(bindHandler(std::move(r.handler), e), e);
 }
 
-void RequestVariantVisitor::operator()(const request::StartDownloading & r) {
+void RequestVariantVisitor::operator()(request::StartDownloading & r) {
 
-    auto e = runTorrentPluginRequest(r.infoHash, [r](const boost::shared_ptr<TorrentPlugin> & plugin) {
+    auto e = runTorrentPluginRequest(r.infoHash, [&r](const boost::shared_ptr<TorrentPlugin> & plugin) {
         plugin->startDownloading(r.contractTx, r.peerToStartDownloadInformationMap);
     });
 
-    sendRequestResult(std::bind(r.handler, e));
+    sendRequestResult(bindHandler(std::move(r.handler), e), e);
 }
 
-void RequestVariantVisitor::operator()(const request::StartUploading & r) {
+void RequestVariantVisitor::operator()(request::StartUploading & r) {
 
-    auto e = runTorrentPluginRequest(r.infoHash, [r](const boost::shared_ptr<TorrentPlugin> & plugin) {
+    auto e = runTorrentPluginRequest(r.infoHash, [&r](const boost::shared_ptr<TorrentPlugin> & plugin) {
         plugin->startUploading(r.peerId, r.terms, r.contractKeyPair, r.finalPkHash);
     });
 
-    sendRequestResult(std::bind(r.handler, e));
+    sendRequestResult(bindHandler(std::move(r.handler), e), e);
 }
 
-void RequestVariantVisitor::operator()(const request::SetLibtorrentInteraction & r) {
+void RequestVariantVisitor::operator()(request::SetLibtorrentInteraction & r) {
 
-    auto e = runTorrentPluginRequest(r.infoHash, [r](const boost::shared_ptr<TorrentPlugin> & plugin) {
+    auto e = runTorrentPluginRequest(r.infoHash, [&r](const boost::shared_ptr<TorrentPlugin> & plugin) {
         plugin->setLibtorrentInteraction(r.libtorrentInteraction);
     });
 
-    sendRequestResult(std::bind(r.handler, e));
+    sendRequestResult(bindHandler(std::move(r.handler), e), e);
 }
 
-void RequestVariantVisitor::operator()(const request::DropPeer & r) {
+void RequestVariantVisitor::operator()(request::DropPeer & r) {
 
-    auto e = runTorrentPluginRequest(r.infoHash, [r](const boost::shared_ptr<TorrentPlugin> & plugin) {
+    auto e = runTorrentPluginRequest(r.infoHash, [&r](const boost::shared_ptr<TorrentPlugin> & plugin) {
         plugin->dropPeer(r.peerId);
     });
 
-    sendRequestResult(std::bind(r.handler, e));
+    sendRequestResult(bindHandler(std::move(r.handler), e), e);
+}
+
+void RequestVariantVisitor::operator()(RequestBatch & r) {
+
+    BatchResultCollector collector;
+    collector.callbacks.reserve(r.requests.size());
+    collector.results.reserve(r.requests.size());
+
+    // Visit all requests in this pass, collecting rather than posting results
+    RequestVariantVisitor batchVisitor(_plugin, _session, _alertManager, &collector);
+
+    for(RequestVariant & v : r.requests) {
+
+        const std::size_t resultsBefore = collector.results.size();
+
+        v.apply_visitor(batchVisitor);
+
+        // Requests without any result, e.g. status updates, still get an entry
+        if(collector.results.size() == resultsBefore)
+            collector.results.push_back(std::exception_ptr());
+    }
+
+    // Single callback running all request handlers in order, followed by batch handler
+    alert::LoadedCallback callback = std::bind([](std::vector<alert::LoadedCallback> & callbacks,
+                                                  const std::vector<std::exception_ptr> & results,
+                                                  const request::BatchHandler & handler) {
+        for(const alert::LoadedCallback & c : callbacks)
+            if(c)
+                c();
+
+        if(handler)
+            handler(results);
+    }, std::move(collector.callbacks), collector.results, std::move(r.handler));
+
+    // A batch within a batch is just another result of the outer batch
+    if(_batchResultCollector)
+        sendRequestResult(std::move(callback));
+    else if(_executor && *_executor)
+        execute(std::move(callback));
+    else
+        _alertManager->emplace_alert<alert::BatchRequestResult>(std::move(callback), std::move(collector.results));
 }
 
 std::exception_ptr RequestVariantVisitor::runTorrentPluginRequest(const libtorrent::sha1_hash & infoHash,
                                                                   const std::function<void(const boost::shared_ptr<TorrentPlugin> &)> & f) const {
 
-    auto pluginMap = _plugin->torrentPlugins();
+    const auto & pluginMap = _plugin->torrentPlugins();
 
     // Make sure there is a torrent plugin for this torrent
     auto it = pluginMap.find(infoHash);
@@ -316,13 +446,34 @@ std::exception_ptr RequestVariantVisitor::runTorrentPluginRequest(const libtorre
         } catch (...) {
             e = std::current_exception();
         }
+
+        // Make outcome visible to Plugin::readStatus right away
+        plugin->publishStatus();
     }
 
     return e;
 }
 
-void RequestVariantVisitor::sendRequestResult(const alert::LoadedCallback & c) {
-    _alertManager->emplace_alert<alert::RequestResult>(c);
+void RequestVariantVisitor::sendRequestResult(alert::LoadedCallback && c, const std::exception_ptr & e) {
+
+    if(_batchResultCollector) {
+        _batchResultCollector->callbacks.push_back(std::move(c));
+        _batchResultCollector->results.push_back(e);
+    } else if(_executor && *_executor)
+        execute(std::move(c));
+    else
+        _alertManager->emplace_alert<alert::RequestResult>(std::move(c));
+}
+
+void RequestVariantVisitor::execute(alert::LoadedCallback && c) {
+
+    try {
+        (*_executor)(std::move(c));
+    } catch(std::exception & e) {
+        JOYSTREAM_EXTENSION_LOG(Error, "Request completion threw: " << e.what());
+    } catch(...) {
+        JOYSTREAM_EXTENSION_LOG(Error, "Request completion threw");
+    }
 }
 
 
@@ -0,0 +1,306 @@
+/**
+ * Copyright (C) JoyStream - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#define BOOST_TEST_MODULE ExtendedMessageIdMapping
+#include <boost/test/included/unit_test.hpp>
+
+#include <extension/ExtendedMessageIdMapping.hpp>
+#include <libtorrent/bencode.hpp>
+#include <libtorrent/bdecode.hpp>
+
+#include <iterator>
+#include <string>
+#include <vector>
+
+using namespace joystream::extension;
+
+namespace {
+
+// Every message type, in order
+std::vector<MessageType> allMessageTypes() {
+
+    std::vector<MessageType> types;
+
+    for(std::size_t i = 0;i < numberOfMessageTypes;i++)
+        types.push_back(static_cast<MessageType>(i));
+
+    return types;
+}
+
+std::string key(MessageType type) {
+    return std::string(CLIENT_PREFIX_STRING) + getMessageName(type);
+}
+
+// m dictionary as received in extended handshake, node refers to buffer
+struct EncodedDictionary {
+
+    explicit EncodedDictionary(const libtorrent::entry & m) {
+
+        libtorrent::bencode(std::back_inserter(buffer), m);
+
+        libtorrent::error_code ec;
+        libtorrent::bdecode(buffer.data(), buffer.data() + buffer.size(), node, ec);
+
+        BOOST_REQUIRE(!ec);
+    }
+
+    std::vector<char> buffer;
+
+    libtorrent::bdecode_node node;
+};
+
+libtorrent::entry consecutiveDictionary(uint8_t start) {
+
+    libtorrent::entry m(libtorrent::entry::dictionary_t);
+
+    ExtendedMessageIdMapping::consecutiveIdsStartingAt(start).writeToMDictionary(m.dict());
+
+    return m;
+}
+
+}
+
+BOOST_AUTO_TEST_CASE(ids_and_message_types_are_inverse) {
+
+    const ExtendedMessageIdMapping mapping = ExtendedMessageIdMapping::consecutiveIdsStartingAt(60);
+
+    BOOST_CHECK(!mapping.empty());
+
+    for(MessageType type : allMessageTypes()) {
+
+        const uint8_t id = mapping.id(type);
+
+        BOOST_CHECK_EQUAL(id, 60 + static_cast<int>(type));
+        BOOST_CHECK(mapping.messageType(id) == type);
+    }
+
+    // Ids around mapped range
+    BOOST_CHECK_THROW(mapping.messageType(59), exception::InvalidMessageMappingDictionary);
+    BOOST_CHECK_THROW(mapping.messageType(60 + numberOfMessageTypes), exception::InvalidMessageMappingDictionary);
+    BOOST_CHECK_THROW(mapping.messageType(0), exception::InvalidMessageMappingDictionary);
+    BOOST_CHECK_THROW(mapping.messageType(255), exception::InvalidMessageMappingDictionary);
+}
+
+BOOST_AUTO_TEST_CASE(mapping_at_end_of_id_range) {
+
+    const uint8_t start = 256 - numberOfMessageTypes;
+
+    const ExtendedMessageIdMapping mapping = ExtendedMessageIdMapping::consecutiveIdsStartingAt(start);
+
+    BOOST_CHECK(mapping.messageType(255) == MessageType::speedTestPayload);
+    BOOST_CHECK(mapping.messageType(start) == MessageType::observe);
+}
+
+BOOST_AUTO_TEST_CASE(empty_mapping_refuses_lookups) {
+
+    ExtendedMessageIdMapping mapping;
+
+    BOOST_CHECK(mapping.empty());
+    BOOST_CHECK_THROW(mapping.id(MessageType::buy), exception::InvalidOperationOnEmptyMappingException);
+    BOOST_CHECK_THROW(mapping.messageType(0), exception::InvalidOperationOnEmptyMappingException);
+
+    libtorrent::entry::dictionary_type m;
+
+    BOOST_CHECK_THROW(mapping.writeToMDictionary(m), exception::InvalidOperationOnEmptyMappingException);
+
+    // Cleared mapping is empty again
+    mapping = ExtendedMessageIdMapping::consecutiveIdsStartingAt(10);
+    mapping.clear();
+
+    BOOST_CHECK(mapping.empty());
+    BOOST_CHECK_THROW(mapping.messageType(10), exception::InvalidOperationOnEmptyMappingException);
+}
+
+BOOST_AUTO_TEST_CASE(copies_are_independent) {
+
+    ExtendedMessageIdMapping mapping = ExtendedMessageIdMapping::consecutiveIdsStartingAt(10);
+    const ExtendedMessageIdMapping copy(mapping);
+
+    mapping = ExtendedMessageIdMapping::consecutiveIdsStartingAt(100);
+
+    BOOST_CHECK_EQUAL(copy.id(MessageType::observe), 10);
+    BOOST_CHECK(copy.messageType(10) == MessageType::observe);
+    BOOST_CHECK_THROW(copy.messageType(100), exception::InvalidMessageMappingDictionary);
+}
+
+BOOST_AUTO_TEST_CASE(mapping_survives_handshake_dictionary) {
+
+    const EncodedDictionary m(consecutiveDictionary(30));
+
+    const ExtendedMessageIdMapping mapping = ExtendedMessageIdMapping::fromMDictionary(m.node);
+
+    for(MessageType type : allMessageTypes()) {
+        BOOST_CHECK_EQUAL(mapping.id(type), 30 + static_cast<int>(type));
+        BOOST_CHECK(mapping.messageType(30 + static_cast<int>(type)) == type);
+    }
+
+    // Writing again into same dictionary is refused
+    libtorrent::entry::dictionary_type written;
+    ExtendedMessageIdMapping copy(mapping);
+
+    copy.writeToMDictionary(written);
+
+    BOOST_CHECK_EQUAL(written.size(), numberOfMessageTypes);
+    BOOST_CHECK_THROW(copy.writeToMDictionary(written), exception::MessageAlreadyPresentException);
+}
+
+BOOST_AUTO_TEST_CASE(lowest_message_keeps_shared_id) {
+
+    libtorrent::entry m = consecutiveDictionary(30);
+
+    // payment and sell both on id of sell
+    m[key(MessageType::payment)] = libtorrent::entry(boost::int64_t(30 + static_cast<int>(MessageType::sell)));
+
+    const EncodedDictionary encoded(m);
+
+    const ExtendedMessageIdMapping mapping = ExtendedMessageIdMapping::fromMDictionary(encoded.node);
+
+    BOOST_CHECK_EQUAL(mapping.id(MessageType::payment), mapping.id(MessageType::sell));
+    BOOST_CHECK(mapping.messageType(mapping.id(MessageType::payment)) == MessageType::sell);
+
+    // Old id of payment is no longer mapped
+    BOOST_CHECK_THROW(mapping.messageType(30 + static_cast<int>(MessageType::payment)), exception::InvalidMessageMappingDictionary);
+}
+
+BOOST_AUTO_TEST_CASE(invalid_dictionaries_are_rejected) {
+
+    typedef exception::InvalidMessageMappingDictionary::Problem Problem;
+
+    struct Case {
+        Problem problem;
+        libtorrent::entry m;
+    };
+
+    std::vector<Case> cases;
+
+    {
+        libtorrent::entry m = consecutiveDictionary(30);
+        m.dict().erase(key(MessageType::ready));
+        cases.push_back({Problem::IncompleteMessageSet, m});
+    }
+
+    {
+        libtorrent::entry m = consecutiveDictionary(30);
+        m[key(MessageType::buy)] = libtorrent::entry(boost::int64_t(-1));
+        cases.push_back({Problem::MessageIdNegativeException, m});
+    }
+
+    {
+        libtorrent::entry m = consecutiveDictionary(30);
+        m[key(MessageType::buy)] = libtorrent::entry(std::string("30"));
+        cases.push_back({Problem::MessageMapsToInvalidValueTypeException, m});
+    }
+
+    {
+        libtorrent::entry m = consecutiveDictionary(30);
+        m[key(MessageType::buy)] = libtorrent::entry(boost::int64_t(0));
+        cases.push_back({Problem::ZeroIdInvalidOnNonUninstallMapping, m});
+    }
+
+    {
+        libtorrent::entry m(libtorrent::entry::dictionary_t);
+        ExtendedMessageIdMapping::writeUninstallMappingToMDictionary(m.dict());
+        cases.push_back({Problem::UninstallMappingFound, m});
+    }
+
+    for(const Case & c : cases) {
+
+        const EncodedDictionary encoded(c.m);
+
+        try {
+            ExtendedMessageIdMapping::fromMDictionary(encoded.node);
+            BOOST_ERROR("Invalid dictionary accepted");
+        } catch(const exception::InvalidMessageMappingDictionary & e) {
+            BOOST_CHECK(e.problem == c.problem);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(try_message_type_does_not_throw) {
+
+    const ExtendedMessageIdMapping mapping = ExtendedMessageIdMapping::consecutiveIdsStartingAt(60);
+
+    for(MessageType type : allMessageTypes()) {
+
+        const boost::optional<MessageType> found = mapping.tryMessageType(mapping.id(type));
+
+        BOOST_REQUIRE(found);
+        BOOST_CHECK(*found == type);
+    }
+
+    // Ids of other extensions, e.g. ut_metadata, and unused ids
+    BOOST_CHECK(!mapping.tryMessageType(0));
+    BOOST_CHECK(!mapping.tryMessageType(2));
+    BOOST_CHECK(!mapping.tryMessageType(59));
+    BOOST_CHECK(!mapping.tryMessageType(255));
+
+    // Empty mapping has no messages at all
+    const ExtendedMessageIdMapping empty;
+
+    for(int id = 0;id < 256;id++)
+        BOOST_REQUIRE(!empty.tryMessageType(static_cast<uint8_t>(id)));
+}
+
+BOOST_AUTO_TEST_CASE(problem_is_reported_without_throwing) {
+
+    typedef exception::InvalidMessageMappingDictionary::Problem Problem;
+
+    boost::optional<Problem> problem;
+
+    {
+        const EncodedDictionary m(consecutiveDictionary(30));
+
+        const ExtendedMessageIdMapping mapping = ExtendedMessageIdMapping::fromMDictionary(m.node, problem);
+
+        BOOST_CHECK(!problem);
+        BOOST_CHECK(!mapping.empty());
+        BOOST_CHECK_EQUAL(mapping.id(MessageType::observe), 30);
+    }
+
+    {
+        libtorrent::entry m = consecutiveDictionary(30);
+        m[key(MessageType::sell)] = libtorrent::entry(boost::int64_t(-3));
+
+        const EncodedDictionary encoded(m);
+
+        const ExtendedMessageIdMapping mapping = ExtendedMessageIdMapping::fromMDictionary(encoded.node, problem);
+
+        BOOST_REQUIRE(problem);
+        BOOST_CHECK(*problem == Problem::MessageIdNegativeException);
+        BOOST_CHECK(mapping.empty());
+    }
+
+    // Problem of earlier call does not linger
+    {
+        const EncodedDictionary m(consecutiveDictionary(40));
+
+        ExtendedMessageIdMapping::fromMDictionary(m.node, problem);
+
+        BOOST_CHECK(!problem);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(keys_of_other_extensions_are_ignored) {
+
+    libtorrent::entry m = consecutiveDictionary(30);
+
+    m["ut_metadata"] = libtorrent::entry(boost::int64_t(2));
+    m["ut_pex"] = libtorrent::entry(std::string("not an id"));
+    m[CLIENT_PREFIX_STRING] = libtorrent::entry(boost::int64_t(5));
+    m[std::string(CLIENT_PREFIX_STRING) + "no_such_message"] = libtorrent::entry(boost::int64_t(7));
+
+    const EncodedDictionary encoded(m);
+
+    boost::optional<exception::InvalidMessageMappingDictionary::Problem> problem;
+
+    const ExtendedMessageIdMapping mapping = ExtendedMessageIdMapping::fromMDictionary(encoded.node, problem);
+
+    BOOST_CHECK(!problem);
+    BOOST_CHECK(!mapping.tryMessageType(2));
+    BOOST_CHECK(!mapping.tryMessageType(5));
+    BOOST_CHECK(!mapping.tryMessageType(7));
+    BOOST_CHECK(mapping.tryMessageType(30));
+}
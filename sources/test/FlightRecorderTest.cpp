@@ -0,0 +1,89 @@
+/**
+ * Copyright (C) JoyStream - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#define BOOST_TEST_MODULE FlightRecorder
+#include <boost/test/included/unit_test.hpp>
+
+#include <extension/FlightRecorder.hpp>
+
+using namespace joystream::extension;
+
+BOOST_AUTO_TEST_CASE(records_are_kept_oldest_first) {
+
+    FlightRecorder recorder;
+
+    BOOST_CHECK(recorder.records().empty());
+
+    recorder.record(FlightRecord::Kind::AddedToSession);
+    recorder.record(FlightRecord::Kind::MessageSent, 3, 120);
+    recorder.record(FlightRecord::Kind::MessageReceived, 4, 80);
+
+    const std::vector<FlightRecord> records = recorder.records();
+
+    BOOST_REQUIRE_EQUAL(records.size(), 3);
+    BOOST_CHECK(records[0].kind == FlightRecord::Kind::AddedToSession);
+    BOOST_CHECK(records[1].kind == FlightRecord::Kind::MessageSent);
+    BOOST_CHECK_EQUAL(records[1].detail, 3);
+    BOOST_CHECK_EQUAL(records[1].size, 120);
+    BOOST_CHECK(records[2].kind == FlightRecord::Kind::MessageReceived);
+    BOOST_CHECK_LE(records[0].time, records[2].time);
+    BOOST_CHECK_EQUAL(recorder.recorded(), 3);
+}
+
+BOOST_AUTO_TEST_CASE(only_latest_records_are_retained) {
+
+    FlightRecorder recorder;
+
+    const std::size_t capacity = FlightRecorder::capacity;
+    const uint32_t total = capacity * 2 + 5;
+
+    for(uint32_t i = 0;i < total;i++)
+        recorder.record(FlightRecord::Kind::MessageSent, 0, i);
+
+    const std::vector<FlightRecord> records = recorder.records();
+
+    BOOST_REQUIRE_EQUAL(records.size(), capacity);
+    BOOST_CHECK_EQUAL(recorder.recorded(), total);
+
+    for(std::size_t i = 0;i < records.size();i++)
+        BOOST_REQUIRE_EQUAL(records[i].size, total - capacity + i);
+}
+
+BOOST_AUTO_TEST_CASE(routine_records_are_not_noteworthy) {
+
+    FlightRecorder recorder;
+
+    recorder.record(FlightRecord::Kind::Handshake);
+    recorder.record(FlightRecord::Kind::AddedToSession);
+    recorder.record(FlightRecord::Kind::MessageSent);
+    recorder.record(FlightRecord::Kind::MessageReceived);
+    recorder.record(FlightRecord::Kind::Dropped);
+
+    BOOST_CHECK(!recorder.noteworthy());
+
+    recorder.markNoteworthy();
+
+    BOOST_CHECK(recorder.noteworthy());
+}
+
+BOOST_AUTO_TEST_CASE(records_of_something_gone_wrong_are_noteworthy) {
+
+    const FlightRecord::Kind kinds[] = {
+        FlightRecord::Kind::MalformedMessage,
+        FlightRecord::Kind::RemovedFromSession,
+        FlightRecord::Kind::Banned
+    };
+
+    for(FlightRecord::Kind kind : kinds) {
+
+        FlightRecorder recorder;
+
+        recorder.record(FlightRecord::Kind::MessageReceived);
+        recorder.record(kind);
+
+        BOOST_CHECK(recorder.noteworthy());
+    }
+}
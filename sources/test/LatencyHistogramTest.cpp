@@ -0,0 +1,111 @@
+/**
+ * Copyright (C) JoyStream - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#define BOOST_TEST_MODULE LatencyHistogram
+#include <boost/test/included/unit_test.hpp>
+
+#include <extension/LatencyHistogram.hpp>
+
+#include <limits>
+
+using joystream::extension::LatencyHistogram;
+
+BOOST_AUTO_TEST_CASE(empty_histogram_reports_zero) {
+
+    LatencyHistogram histogram;
+
+    BOOST_CHECK_EQUAL(histogram.count(), 0);
+    BOOST_CHECK_EQUAL(histogram.min().count(), 0);
+    BOOST_CHECK_EQUAL(histogram.max().count(), 0);
+    BOOST_CHECK_EQUAL(histogram.mean().count(), 0);
+    BOOST_CHECK_EQUAL(histogram.percentile(99).count(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(buckets_cover_values_without_gaps) {
+
+    BOOST_CHECK_EQUAL(LatencyHistogram::bucketLowerBound(0), 0);
+
+    for(int i = 0;i < LatencyHistogram::bucketCount - 1;i++) {
+
+        BOOST_REQUIRE_EQUAL(LatencyHistogram::bucketUpperBound(i) + 1, LatencyHistogram::bucketLowerBound(i + 1));
+        BOOST_REQUIRE_EQUAL(LatencyHistogram::bucketIndex(LatencyHistogram::bucketLowerBound(i)), i);
+        BOOST_REQUIRE_EQUAL(LatencyHistogram::bucketIndex(LatencyHistogram::bucketUpperBound(i)), i);
+    }
+
+    BOOST_CHECK_EQUAL(LatencyHistogram::bucketIndex(std::numeric_limits<uint64_t>::max()), LatencyHistogram::bucketCount - 1);
+}
+
+BOOST_AUTO_TEST_CASE(bucket_width_bounds_relative_error) {
+
+    for(int i = LatencyHistogram::subBucketCount;i < LatencyHistogram::bucketCount - 1;i++) {
+
+        const uint64_t lower = LatencyHistogram::bucketLowerBound(i);
+        const uint64_t width = LatencyHistogram::bucketUpperBound(i) - lower + 1;
+
+        BOOST_REQUIRE_LE(width * LatencyHistogram::subBucketCount, lower);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(summary_statistics_are_exact) {
+
+    LatencyHistogram histogram;
+
+    histogram.record(std::chrono::nanoseconds(100));
+    histogram.record(std::chrono::nanoseconds(200));
+    histogram.record(std::chrono::nanoseconds(600));
+    histogram.record(std::chrono::nanoseconds(-5));
+
+    BOOST_CHECK_EQUAL(histogram.count(), 4);
+    BOOST_CHECK_EQUAL(histogram.min().count(), 0);
+    BOOST_CHECK_EQUAL(histogram.max().count(), 600);
+    BOOST_CHECK_EQUAL(histogram.mean().count(), 225);
+}
+
+BOOST_AUTO_TEST_CASE(percentiles_are_within_bucket_of_value) {
+
+    LatencyHistogram histogram;
+
+    for(int i = 1;i <= 1000;i++)
+        histogram.record(std::chrono::microseconds(i));
+
+    const int64_t median = histogram.percentile(50).count();
+    const int64_t tail = histogram.percentile(99).count();
+
+    BOOST_CHECK_GE(median, 500000);
+    BOOST_CHECK_LE(median, 500000 + 500000 / LatencyHistogram::subBucketCount);
+    BOOST_CHECK_GE(tail, 990000);
+    BOOST_CHECK_LE(tail, 1000000);
+
+    // Never beyond largest recorded value
+    BOOST_CHECK_EQUAL(histogram.percentile(100).count(), 1000000);
+}
+
+BOOST_AUTO_TEST_CASE(combined_histogram_matches_single_histogram) {
+
+    LatencyHistogram a, b, all;
+
+    for(int i = 0;i < 100;i++) {
+        a.record(std::chrono::nanoseconds(i * 37));
+        b.record(std::chrono::nanoseconds(i * 1009));
+        all.record(std::chrono::nanoseconds(i * 37));
+        all.record(std::chrono::nanoseconds(i * 1009));
+    }
+
+    a.add(b);
+
+    BOOST_CHECK_EQUAL(a.count(), all.count());
+    BOOST_CHECK_EQUAL(a.min().count(), all.min().count());
+    BOOST_CHECK_EQUAL(a.max().count(), all.max().count());
+    BOOST_CHECK_EQUAL(a.mean().count(), all.mean().count());
+
+    for(int i = 0;i < LatencyHistogram::bucketCount;i++)
+        BOOST_REQUIRE_EQUAL(a.bucket(i), all.bucket(i));
+
+    a.clear();
+
+    BOOST_CHECK_EQUAL(a.count(), 0);
+    BOOST_CHECK_EQUAL(a.bucket(LatencyHistogram::bucketIndex(37)), 0);
+}
@@ -0,0 +1,196 @@
+/**
+ * Copyright (C) JoyStream - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#define BOOST_TEST_MODULE RequestLane
+#include <boost/test/included/unit_test.hpp>
+
+#include <extension/extension.hpp>
+#include <extension/LatencyHistogram.hpp>
+#include <libtorrent/session.hpp>
+#include <libtorrent/settings_pack.hpp>
+#include <libtorrent/alert_types.hpp>
+#include <libtorrent/time.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace joystream::extension;
+
+namespace {
+
+// Session with plugin added, and a thread running request handlers
+// delivered through alert::RequestResult, as a client would
+class PluginSession {
+
+public:
+
+    explicit PluginSession(const Plugin::Policy & policy)
+        : _plugin(new Plugin(60, Coin::Network::testnet3, nullptr, nullptr, policy))
+        , _session(settings())
+        , _pumping(true) {
+
+        _session.add_extension(boost::static_pointer_cast<libtorrent::plugin>(_plugin));
+
+        _pump = std::thread([this]() {
+
+            std::vector<libtorrent::alert *> alerts;
+
+            while(_pumping.load()) {
+
+                _session.wait_for_alert(libtorrent::milliseconds(10));
+                _session.pop_alerts(&alerts);
+
+                for(libtorrent::alert * a : alerts)
+                    if(alert::RequestResult * r = libtorrent::alert_cast<alert::RequestResult>(a))
+                        r->loadedCallback();
+            }
+        });
+    }
+
+    ~PluginSession() {
+        _pumping.store(false);
+        _pump.join();
+    }
+
+    Plugin & plugin() { return *_plugin; }
+
+    // Time from submitting a control request in given lane until its handler has run
+    std::chrono::nanoseconds controlRoundTrip(request::Priority priority) {
+
+        std::shared_ptr<std::promise<void> > done = std::make_shared<std::promise<void> >();
+        std::future<void> completed = done->get_future();
+
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+        while(!_plugin->submit(request::StopAllTorrentPlugins([done]() { done->set_value(); }), priority))
+            std::this_thread::yield();
+
+        completed.wait();
+
+        return std::chrono::steady_clock::now() - start;
+    }
+
+private:
+
+    static libtorrent::settings_pack settings() {
+
+        libtorrent::settings_pack pack;
+
+        pack.set_str(libtorrent::settings_pack::listen_interfaces, "127.0.0.1:0");
+        pack.set_bool(libtorrent::settings_pack::enable_dht, false);
+        pack.set_bool(libtorrent::settings_pack::enable_lsd, false);
+        pack.set_bool(libtorrent::settings_pack::enable_upnp, false);
+        pack.set_bool(libtorrent::settings_pack::enable_natpmp, false);
+
+        return pack;
+    }
+
+    boost::shared_ptr<Plugin> _plugin;
+
+    libtorrent::session _session;
+
+    std::atomic<bool> _pumping;
+
+    std::thread _pump;
+};
+
+// Keeps bulk lane full of status requests while alive. Requests are for
+// a torrent which does not exist, so they post no alerts
+class BulkFlood {
+
+public:
+
+    explicit BulkFlood(Plugin & plugin)
+        : _flooding(true)
+        , _thread([this, &plugin]() {
+            while(_flooding.load())
+                if(!plugin.submit(request::PostPeerPluginStatusUpdates(libtorrent::sha1_hash())))
+                    std::this_thread::yield();
+        }) {
+    }
+
+    ~BulkFlood() {
+        _flooding.store(false);
+        _thread.join();
+    }
+
+private:
+
+    std::atomic<bool> _flooding;
+
+    std::thread _thread;
+};
+
+}
+
+BOOST_AUTO_TEST_CASE(control_request_overtakes_queued_bulk_requests) {
+
+    // Queue is only processed on tick, so bulk lane can be filled up front
+    Plugin::Policy policy;
+    policy.requestQueueCapacity = 1024;
+    policy.wakeNetworkThreadOnSubmit = false;
+    policy.maxBulkRequestsPerPass = 16;
+
+    PluginSession session(policy);
+
+    while(session.plugin().submit(request::PostPeerPluginStatusUpdates(libtorrent::sha1_hash()))) {}
+
+    std::promise<std::size_t> bulkDepth;
+    std::future<std::size_t> completed = bulkDepth.get_future();
+
+    BOOST_REQUIRE(session.plugin().submit(request::StopAllTorrentPlugins([&session, &bulkDepth]() {
+        bulkDepth.set_value(session.plugin().requestQueueDepth(request::Priority::Bulk));
+    })));
+
+    // Handled within the first passes, while nearly all bulk requests are still
+    // waiting, rather than after all of them as in a single queue
+    BOOST_CHECK_GT(completed.get(), policy.requestQueueCapacity / 2);
+}
+
+BOOST_AUTO_TEST_CASE(control_latency_stays_flat_under_bulk_load) {
+
+    const int samples = 200;
+
+    PluginSession session{Plugin::Policy()};
+
+    LatencyHistogram idle, loaded, loadedBulkLane;
+
+    for(int i = 0;i < samples;i++)
+        idle.record(session.controlRoundTrip(request::Priority::Control));
+
+    {
+        BulkFlood flood(session.plugin());
+
+        // Wait for bulk lane to fill up, i.e. for flood to outpace processing
+        const std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+
+        while(session.plugin().rejectedRequests() == 0 && std::chrono::steady_clock::now() < deadline)
+            std::this_thread::yield();
+
+        BOOST_REQUIRE_GT(session.plugin().rejectedRequests(), 0);
+
+        for(int i = 0;i < samples;i++) {
+            loaded.record(session.controlRoundTrip(request::Priority::Control));
+            loadedBulkLane.record(session.controlRoundTrip(request::Priority::Bulk));
+        }
+    }
+
+    BOOST_TEST_MESSAGE("Control round trip, median/99th percentile in microseconds: idle "
+                       << idle.percentile(50).count() / 1000 << "/" << idle.percentile(99).count() / 1000
+                       << ", under bulk load " << loaded.percentile(50).count() / 1000 << "/" << loaded.percentile(99).count() / 1000
+                       << ", in bulk lane under bulk load " << loadedBulkLane.percentile(50).count() / 1000 << "/" << loadedBulkLane.percentile(99).count() / 1000);
+
+    // Control requests only wait for the pass in progress, whose bulk share is bounded,
+    // while the same request in the bulk lane waits behind the whole backlog
+    const std::chrono::nanoseconds slack = std::chrono::milliseconds(2);
+
+    BOOST_CHECK_LE(loaded.percentile(50).count(), (4 * idle.percentile(50) + slack).count());
+    BOOST_CHECK_LT(loaded.percentile(50).count(), loadedBulkLane.percentile(50).count());
+}
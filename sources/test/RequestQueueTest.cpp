@@ -0,0 +1,224 @@
+/**
+ * Copyright (C) JoyStream - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#define BOOST_TEST_MODULE RequestQueue
+#include <boost/test/included/unit_test.hpp>
+
+#include <extension/RequestQueue.hpp>
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <utility>
+
+using joystream::extension::detail::RequestQueue;
+
+BOOST_AUTO_TEST_CASE(capacity_is_rounded_up_to_power_of_two) {
+
+    BOOST_CHECK_EQUAL(RequestQueue<int>(1).capacity(), 2);
+    BOOST_CHECK_EQUAL(RequestQueue<int>(5).capacity(), 8);
+    BOOST_CHECK_EQUAL(RequestQueue<int>(1024).capacity(), 1024);
+}
+
+BOOST_AUTO_TEST_CASE(elements_come_out_in_order_of_push) {
+
+    RequestQueue<int> queue(8);
+
+    for(int i = 0;i < 5;i++)
+        BOOST_CHECK(queue.tryPush(int(i)));
+
+    BOOST_CHECK_EQUAL(queue.size(), 5);
+
+    int value;
+
+    for(int i = 0;i < 5;i++) {
+        BOOST_REQUIRE(queue.tryPop(value));
+        BOOST_CHECK_EQUAL(value, i);
+    }
+
+    BOOST_CHECK(!queue.tryPop(value));
+    BOOST_CHECK(queue.empty());
+}
+
+BOOST_AUTO_TEST_CASE(full_queue_rejects_push_and_leaves_value_untouched) {
+
+    RequestQueue<std::string> queue(2);
+
+    BOOST_CHECK(queue.tryPush(std::string("a")));
+    BOOST_CHECK(queue.tryPush(std::string("b")));
+
+    std::string rejected("c");
+
+    BOOST_CHECK(!queue.tryPush(std::move(rejected)));
+    BOOST_CHECK_EQUAL(rejected, "c");
+    BOOST_CHECK_EQUAL(queue.size(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(push_until_gives_up_at_deadline) {
+
+    RequestQueue<int> queue(2);
+
+    BOOST_CHECK(queue.tryPush(1));
+    BOOST_CHECK(queue.tryPush(2));
+
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    BOOST_CHECK(!queue.pushUntil(3, start + std::chrono::milliseconds(20)));
+    BOOST_CHECK(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(20));
+}
+
+BOOST_AUTO_TEST_CASE(slots_are_reused_across_laps) {
+
+    RequestQueue<int> queue(4);
+
+    int value;
+
+    for(int i = 0;i < 100;i++) {
+        BOOST_REQUIRE(queue.tryPush(int(i)));
+        BOOST_REQUIRE(queue.tryPop(value));
+        BOOST_CHECK_EQUAL(value, i);
+    }
+
+    BOOST_CHECK(queue.empty());
+}
+
+BOOST_AUTO_TEST_CASE(unconsumed_elements_are_destroyed_with_queue) {
+
+    std::shared_ptr<int> element = std::make_shared<int>(0);
+
+    {
+        RequestQueue<std::shared_ptr<int> > queue(4);
+
+        BOOST_CHECK(queue.tryPush(std::shared_ptr<int>(element)));
+        BOOST_CHECK(queue.tryPush(std::shared_ptr<int>(element)));
+        BOOST_CHECK_EQUAL(element.use_count(), 3);
+    }
+
+    BOOST_CHECK_EQUAL(element.use_count(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(many_producers_single_consumer_keep_each_producers_order) {
+
+    const int producers = 4;
+    const int perProducer = 20000;
+
+    RequestQueue<std::pair<int, int> > queue(64);
+
+    std::vector<std::thread> threads;
+
+    for(int p = 0;p < producers;p++)
+        threads.emplace_back([&queue, p, perProducer]() {
+            for(int i = 0;i < perProducer;i++)
+                while(!queue.tryPush(std::make_pair(p, i)))
+                    std::this_thread::yield();
+        });
+
+    std::vector<int> next(producers, 0);
+    std::pair<int, int> value;
+
+    for(int received = 0;received < producers * perProducer;) {
+
+        if(!queue.tryPop(value)) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        BOOST_REQUIRE_EQUAL(value.second, next[value.first]);
+        next[value.first]++;
+        received++;
+    }
+
+    for(std::thread & t : threads)
+        t.join();
+
+    BOOST_CHECK(queue.empty());
+
+    for(int p = 0;p < producers;p++)
+        BOOST_CHECK_EQUAL(next[p], perProducer);
+}
+
+namespace {
+
+// Element whose construction throws on demand
+struct Fragile {
+
+    Fragile(int value, bool fail)
+        : value(value) {
+        if(fail)
+            throw std::runtime_error("construction failed");
+    }
+
+    int value;
+};
+
+// Element counting live instances, construction throws on demand
+struct Counted {
+
+    static int live;
+
+    Counted(bool fail) {
+        if(fail)
+            throw std::runtime_error("construction failed");
+        live++;
+    }
+
+    Counted(Counted &&) { live++; }
+    Counted & operator=(Counted &&) { return *this; }
+    ~Counted() { live--; }
+};
+
+int Counted::live = 0;
+
+}
+
+BOOST_AUTO_TEST_CASE(emplace_constructs_in_place) {
+
+    RequestQueue<std::pair<int, std::string> > queue(4);
+
+    BOOST_CHECK(queue.tryEmplace(1, "one"));
+    BOOST_CHECK(queue.emplaceUntil(std::chrono::steady_clock::now() + std::chrono::milliseconds(10), 2, "two"));
+
+    std::pair<int, std::string> value;
+
+    BOOST_REQUIRE(queue.tryPop(value));
+    BOOST_CHECK_EQUAL(value.second, "one");
+    BOOST_REQUIRE(queue.tryPop(value));
+    BOOST_CHECK_EQUAL(value.second, "two");
+}
+
+BOOST_AUTO_TEST_CASE(throwing_construction_leaves_skipped_slot) {
+
+    RequestQueue<Fragile> queue(4);
+
+    BOOST_CHECK(queue.tryEmplace(1, false));
+    BOOST_CHECK_THROW(queue.tryEmplace(2, true), std::runtime_error);
+    BOOST_CHECK(queue.tryEmplace(3, false));
+
+    Fragile value(0, false);
+
+    BOOST_REQUIRE(queue.tryPop(value));
+    BOOST_CHECK_EQUAL(value.value, 1);
+    BOOST_REQUIRE(queue.tryPop(value));
+    BOOST_CHECK_EQUAL(value.value, 3);
+    BOOST_CHECK(!queue.tryPop(value));
+    BOOST_CHECK(queue.empty());
+}
+
+BOOST_AUTO_TEST_CASE(only_constructed_elements_are_destroyed_with_queue) {
+
+    {
+        RequestQueue<Counted> queue(4);
+
+        BOOST_CHECK(queue.tryEmplace(false));
+        BOOST_CHECK_THROW(queue.tryEmplace(true), std::runtime_error);
+        BOOST_CHECK(queue.tryEmplace(false));
+        BOOST_CHECK_EQUAL(Counted::live, 2);
+    }
+
+    BOOST_CHECK_EQUAL(Counted::live, 0);
+}
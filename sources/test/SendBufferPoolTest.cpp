@@ -0,0 +1,128 @@
+/**
+ * Copyright (C) JoyStream - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#define BOOST_TEST_MODULE SendBufferPool
+#include <boost/test/included/unit_test.hpp>
+
+#include <extension/SendBufferPool.hpp>
+
+#include <cstring>
+#include <utility>
+
+using joystream::extension::SendBufferPool;
+
+namespace {
+
+// Copied, as static members are not defined out of class
+const std::size_t smallest = SendBufferPool::smallestBufferSize;
+const std::size_t largest = SendBufferPool::largestBufferSize;
+const std::size_t overhead = SendBufferPool::messageOverhead;
+
+}
+
+BOOST_AUTO_TEST_CASE(buffer_capacity_is_power_of_two_plus_overhead) {
+
+    SendBufferPool pool(1024 * 1024);
+
+    BOOST_CHECK_EQUAL(pool.acquire(1).capacity(), smallest + overhead);
+    BOOST_CHECK_EQUAL(pool.acquire(smallest + overhead).capacity(), smallest + overhead);
+    BOOST_CHECK_EQUAL(pool.acquire(smallest + overhead + 1).capacity(), 2 * smallest + overhead);
+
+    // Full piece message of a power of two sized piece fits class of that size
+    SendBufferPool::Buffer piece = pool.acquire(256 * 1024 + 10);
+
+    BOOST_CHECK_EQUAL(piece.capacity(), 256 * 1024 + overhead);
+    BOOST_CHECK_EQUAL(piece.size(), 256 * 1024 + 10);
+
+    // Writable up to capacity
+    std::memset(piece.data(), 0, piece.capacity());
+}
+
+BOOST_AUTO_TEST_CASE(buffers_beyond_largest_class_are_exact_size) {
+
+    SendBufferPool pool(64 * 1024 * 1024);
+
+    BOOST_CHECK_EQUAL(pool.acquire(largest + overhead).capacity(), largest + overhead);
+    BOOST_CHECK_EQUAL(pool.acquire(largest + overhead + 1).capacity(), largest + overhead + 1);
+
+    // Never pooled
+    BOOST_CHECK_EQUAL(pool.statistics().bytesPooled, largest + overhead);
+}
+
+BOOST_AUTO_TEST_CASE(released_buffers_are_reused) {
+
+    SendBufferPool pool(1024 * 1024);
+
+    char * data;
+
+    {
+        SendBufferPool::Buffer buffer = pool.acquire(1000);
+        data = buffer.data();
+    }
+
+    BOOST_CHECK_EQUAL(pool.statistics().misses, 1);
+    BOOST_CHECK_EQUAL(pool.statistics().bytesPooled, 4 * smallest + overhead);
+
+    // Same class
+    SendBufferPool::Buffer buffer = pool.acquire(900);
+
+    BOOST_CHECK_EQUAL(buffer.data(), data);
+    BOOST_CHECK_EQUAL(pool.statistics().hits, 1);
+    BOOST_CHECK_EQUAL(pool.statistics().bytesPooled, 0);
+
+    // Other class
+    SendBufferPool::Buffer other = pool.acquire(100);
+
+    BOOST_CHECK_EQUAL(pool.statistics().misses, 2);
+}
+
+BOOST_AUTO_TEST_CASE(pool_holds_at_most_given_bytes) {
+
+    SendBufferPool pool(smallest + overhead);
+
+    {
+        SendBufferPool::Buffer a = pool.acquire(10);
+        SendBufferPool::Buffer b = pool.acquire(10);
+    }
+
+    BOOST_CHECK_EQUAL(pool.statistics().bytesPooled, smallest + overhead);
+
+    SendBufferPool::Buffer a = pool.acquire(10);
+    SendBufferPool::Buffer b = pool.acquire(10);
+
+    BOOST_CHECK_EQUAL(pool.statistics().hits, 1);
+    BOOST_CHECK_EQUAL(pool.statistics().misses, 3);
+}
+
+BOOST_AUTO_TEST_CASE(statistics_track_capacity_and_requested_size) {
+
+    SendBufferPool pool(1024 * 1024);
+
+    {
+        SendBufferPool::Buffer a = pool.acquire(400);
+        SendBufferPool::Buffer b = pool.acquire(100);
+
+        const joystream::extension::status::SendBufferPool s = pool.statistics();
+
+        BOOST_CHECK_EQUAL(s.buffersInUse, 2);
+        BOOST_CHECK_EQUAL(s.bytesInUse, (2 * smallest + overhead) + (smallest + overhead));
+        BOOST_CHECK_EQUAL(s.requestedBytesInUse, 500);
+
+        // Moving does not release
+        SendBufferPool::Buffer c = std::move(a);
+
+        BOOST_CHECK(a.data() == nullptr);
+        BOOST_CHECK_EQUAL(pool.statistics().buffersInUse, 2);
+    }
+
+    const joystream::extension::status::SendBufferPool s = pool.statistics();
+
+    BOOST_CHECK_EQUAL(s.buffersInUse, 0);
+    BOOST_CHECK_EQUAL(s.bytesInUse, 0);
+    BOOST_CHECK_EQUAL(s.requestedBytesInUse, 0);
+    BOOST_CHECK_EQUAL(s.peakBuffersInUse, 2);
+    BOOST_CHECK_EQUAL(s.peakRequestedBytesInUse, 500);
+}
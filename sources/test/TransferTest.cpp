@@ -0,0 +1,104 @@
+/**
+ * Copyright (C) JoyStream - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#define BOOST_TEST_MODULE Transfer
+#include <boost/test/included/unit_test.hpp>
+
+#include <extension/Transfer.hpp>
+
+#include <cmath>
+
+using namespace joystream::extension;
+
+namespace {
+
+const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+std::chrono::steady_clock::time_point at(double seconds) {
+    return start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(seconds));
+}
+
+}
+
+BOOST_AUTO_TEST_CASE(rate_is_zero_before_anything_is_added) {
+
+    RateEstimator estimator;
+
+    BOOST_CHECK_EQUAL(estimator.rate(at(0)), 0);
+    BOOST_CHECK_EQUAL(estimator.rate(at(100)), 0);
+}
+
+BOOST_AUTO_TEST_CASE(steady_transfers_converge_to_their_rate) {
+
+    RateEstimator estimator;
+
+    // 1000 bytes every 100ms, for ten time constants
+    for(int i = 0;i < 1000;i++)
+        estimator.add(1000, at(i * 0.1));
+
+    BOOST_CHECK_CLOSE(estimator.rate(at(99.9)), 10000, 1);
+}
+
+BOOST_AUTO_TEST_CASE(rate_decays_by_time_constant) {
+
+    RateEstimator estimator;
+
+    estimator.add(500, at(0));
+
+    const double initial = estimator.rate(at(0));
+
+    BOOST_CHECK_CLOSE(initial, 500 / TransferAccounting::timeConstant, 1e-9);
+    BOOST_CHECK_CLOSE(estimator.rate(at(TransferAccounting::timeConstant)), initial / std::exp(1.0), 1e-6);
+
+    // Reading rate does not change it
+    BOOST_CHECK_CLOSE(estimator.rate(at(TransferAccounting::timeConstant)), initial / std::exp(1.0), 1e-6);
+}
+
+BOOST_AUTO_TEST_CASE(accounting_keeps_totals_and_rates_per_event) {
+
+    TransferAccounting accounting;
+
+    accounting.record(TransferEvent::PieceSent, 16384, at(0));
+    accounting.record(TransferEvent::PieceSent, 16384, at(1));
+    accounting.record(TransferEvent::PaymentReceived, 25, at(1));
+
+    const status::Transfer transfer = accounting.status(at(1));
+
+    BOOST_CHECK_EQUAL(transfer.piecesSent.count, 2);
+    BOOST_CHECK_EQUAL(transfer.piecesSent.amount, 32768);
+    BOOST_CHECK_GT(transfer.piecesSent.amountRate, 0);
+    BOOST_CHECK_GT(transfer.piecesSent.countRate, 0);
+
+    BOOST_CHECK_EQUAL(transfer.paymentsReceived.count, 1);
+    BOOST_CHECK_EQUAL(transfer.paymentsReceived.amount, 25);
+
+    BOOST_CHECK_EQUAL(transfer.piecesReceived.count, 0);
+    BOOST_CHECK_EQUAL(transfer.piecesReceived.amountRate, 0);
+    BOOST_CHECK_EQUAL(transfer.paymentsSent.count, 0);
+
+    // Totals remain, rates fade
+    const status::Transfer later = accounting.status(at(1000));
+
+    BOOST_CHECK_EQUAL(later.piecesSent.amount, 32768);
+    BOOST_CHECK_LT(later.piecesSent.amountRate, 1e-30);
+}
+
+BOOST_AUTO_TEST_CASE(transfers_add_up) {
+
+    status::Transfer a, b;
+
+    a.piecesSent.count = 1;
+    a.piecesSent.amountRate = 1.5;
+    b.piecesSent.count = 2;
+    b.piecesSent.amountRate = 2.5;
+    b.paymentsReceived.amount = 7;
+
+    a += b;
+
+    BOOST_CHECK_EQUAL(a.piecesSent.count, 3);
+    BOOST_CHECK_EQUAL(a.piecesSent.amountRate, 4);
+    BOOST_CHECK_EQUAL(a.paymentsReceived.amount, 7);
+}